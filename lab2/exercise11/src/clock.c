@@ -0,0 +1,177 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  clock - tick clock shared by HOST dispatcher and 'process'
+
+   'process' used to tick with sleep(1) and a times() check of whether
+   an interrupted sleep had lasted long enough to count, so every tick
+   was one second plus whatever the tick's own work took, and it kept
+   no relation to the dispatcher's ticks. Over a few hundred ticks the
+   two drifted apart. Here a tick is a boundary on a grid - epoch plus
+   a whole number of ticks on CLOCK_MONOTONIC - and is slept to with
+   clock_nanosleep(TIMER_ABSTIME), so time spent on one tick's work is
+   taken out of the next sleep instead of adding up.
+
+   The dispatcher hands its grid to every process it starts through
+   the environment (CLOCK_ENV, set by clockExport before the start,
+   passed on to parked workers with their job), so both count the
+   same ticks at whatever tick length hostd was given (-t).
+
+   long long clockNow (void)
+    returns CLOCK_MONOTONIC in nanoseconds
+
+   long long clockNext (long long epoch, long long tick, long long now)
+    returns the first boundary epoch + k * tick later than now
+
+   int clockSleepUntil (long long deadline)
+      - sleep until CLOCK_MONOTONIC reaches deadline (ns)
+    returns:
+      0 once it has
+      EINTR if a signal handler ran first (the caller decides whether
+        to sleep on)
+
+   void clockExport (long long epoch, long long tick, int stats)
+      - put the tick grid (and whether to print statistics) in the
+        environment for processes started from now on
+    returns NONE
+
+   int clockImport (long long * epoch, long long * tick, int * stats)
+      - read the tick grid from the environment
+    returns:
+      TRUE if it was there (epoch, tick and stats set)
+      FALSE if not (nothing set)
+
+   void clockLate (ClockStatsPtr s, long long deadline, long long now,
+                   long long missed)
+      - count a tick due at deadline and noticed at now, missed whole
+        ticks having gone by unnoticed in between
+    returns NONE
+
+   void clockPrint (ClockStatsPtr s, char * name, FILE * iostream)
+      - print the ticks, mean and worst lateness and overruns in s
+    returns NONE
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: absolute tick deadlines, epoch handed to processes
+
+ *******************************************************************/
+
+#include "clock.h"
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+
+/*******************************************************
+ * long long clockNow (void)
+ *
+ * returns CLOCK_MONOTONIC in nanoseconds
+ *******************************************************/
+long long clockNow(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * CLOCK_NS + t.tv_nsec;
+}
+
+/*******************************************************
+ * long long clockNext (long long epoch, long long tick, long long now)
+ *
+ * returns the first tick boundary after now
+ *******************************************************/
+long long clockNext(long long epoch, long long tick, long long now)
+{
+    if (now < epoch)
+        return epoch;
+    return epoch + ((now - epoch) / tick + 1) * tick;
+}
+
+/*******************************************************
+ * int clockSleepUntil (long long deadline)
+ *    - sleep to an absolute time
+ *
+ * returns:
+ *    0 if deadline reached
+ *    EINTR if interrupted by a signal handler
+ *******************************************************/
+int clockSleepUntil(long long deadline)
+{
+    struct timespec t;
+
+    t.tv_sec = deadline / CLOCK_NS;
+    t.tv_nsec = deadline % CLOCK_NS;
+    return clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL);
+}
+
+/*******************************************************
+ * void clockExport (long long epoch, long long tick, int stats)
+ *    - hand the tick grid to processes started from now on
+ *
+ * returns NONE
+ *******************************************************/
+void clockExport(long long epoch, long long tick, int stats)
+{
+    char value[64];
+
+    snprintf(value, sizeof(value), "%lld %lld %d", epoch, tick, stats);
+    setenv(CLOCK_ENV, value, TRUE);
+}
+
+/*******************************************************
+ * int clockImport (long long * epoch, long long * tick, int * stats)
+ *    - take up the dispatcher's tick grid
+ *
+ * returns:
+ *    TRUE if it was handed down
+ *    FALSE if not
+ *******************************************************/
+int clockImport(long long * epoch, long long * tick, int * stats)
+{
+    char * value = getenv(CLOCK_ENV);
+    long long e, t;
+    int s;
+
+    if (!value || sscanf(value, "%lld %lld %d", &e, &t, &s) != 3 || t <= 0)
+        return FALSE;
+    *epoch = e;
+    *tick = t;
+    *stats = s;
+    return TRUE;
+}
+
+/*******************************************************
+ * void clockLate (ClockStatsPtr s, long long deadline, long long now,
+ *                 long long missed)
+ *    - count a tick's lateness
+ *
+ * returns NONE
+ *******************************************************/
+void clockLate(ClockStatsPtr s, long long deadline, long long now,
+               long long missed)
+{
+    long long late = now > deadline ? now - deadline : 0;
+
+    s->ticks++;
+    s->missed += missed;
+    s->latens += late;
+    if (late > s->maxns)
+        s->maxns = late;
+}
+
+/*******************************************************
+ * void clockPrint (ClockStatsPtr s, char * name, FILE * iostream)
+ *    - print lateness statistics
+ *
+ * returns NONE
+ *******************************************************/
+void clockPrint(ClockStatsPtr s, char * name, FILE * stream)
+{
+    fprintf(stream, "%s: %lld ticks, late by %.1f us mean, %.1f us worst, "
+        "%lld ticks overrun\n", name, s->ticks,
+        s->ticks ? s->latens / 1e3 / s->ticks : 0.0, s->maxns / 1e3,
+        s->missed);
+}
@@ -0,0 +1,67 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  clock - tick clock shared by HOST dispatcher and 'process'
+
+  long long clockNow (void) - CLOCK_MONOTONIC in nanoseconds
+  long long clockNext (long long epoch, long long tick, long long now)
+      - first tick boundary after now
+  int clockSleepUntil (long long deadline) - sleep to an absolute time
+  void clockExport (long long epoch, long long tick, int stats)
+      - hand the dispatcher's tick to processes it starts
+  int clockImport (long long * epoch, long long * tick, int * stats)
+      - take up the dispatcher's tick
+  void clockLate (ClockStatsPtr s, long long deadline, long long now,
+      long long missed) - count a tick's lateness
+  void clockPrint (ClockStatsPtr s, char * name, FILE * iostream)
+      - print lateness statistics
+
+  see clock.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: absolute tick deadlines, epoch handed to processes
+
+ *******************************************************************/
+
+#include <stdio.h>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+/* clock definitions *******************************************/
+
+#define CLOCK_ENV "HOSTD_CLOCK"  /* "epoch tick stats", all in ns but stats */
+#define CLOCK_NS  1000000000LL   /* nanoseconds in a second */
+
+struct clockstats {
+    long long ticks;           // deadlines met (however late)
+    long long missed;          // whole ticks overrun
+    long long latens;          // lateness summed over ticks
+    long long maxns;           //  and the worst
+};
+
+typedef struct clockstats ClockStats;
+typedef ClockStats * ClockStatsPtr;
+
+/* clock prototypes ********************************************/
+
+long long clockNow(void);
+long long clockNext(long long, long long, long long);
+int  clockSleepUntil(long long);
+void clockExport(long long, long long, int);
+int  clockImport(long long *, long long *, int *);
+void clockLate(ClockStatsPtr, long long, long long, long long);
+void clockPrint(ClockStatsPtr, char *, FILE *);
+
+#endif
@@ -0,0 +1,173 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  hostd-convert - convert dispatch files between text and binary
+
+  usage:
+
+    hostd-convert [-i stride] <input file> <output file>
+
+  a text dispatch file is written as a binary one (see jobfile.c) and
+  a binary one is written back as text, whichever the input is. Text
+  lines out of arrival order are sorted (keeping the order of jobs
+  arriving together) since a binary file must be in arrival order.
+  -i sets the number of records per arrival index entry (default 512).
+  The tickets and deadline fields are written to text only when they
+  were given.
+
+ ********************************************************************
+
+  version: 1.2
+  history:
+     v1.0: text <-> binary
+     v1.1: optional tickets field
+     v1.2: optional deadline field
+
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "parse.h"
+#include "jobfile.h"
+
+#define DEFAULT_NAME "hostd-convert"
+
+struct record {
+    int fields[JOB_FIELDS];
+    size_t line;               // keeps equal arrivals in file order
+};
+
+typedef struct record Record;
+
+static void PrintUsage(char * progname)
+{
+    fprintf(stderr, "usage: %s [-i stride] <input file> <output file>\n",
+        progname ? progname : DEFAULT_NAME);
+    exit(127);
+}
+
+static int CompareArrival(const void * a, const void * b)
+{
+    const Record * x = a, * y = b;
+
+    if (x->fields[0] != y->fields[0])
+        return x->fields[0] < y->fields[0] ? -1 : 1;
+    return x->line < y->line ? -1 : x->line > y->line;
+}
+
+/* text -> binary */
+static int ToBinary(char * in, char * out, int stride)
+{
+    Parser parser;
+    JobWriter writer;
+    Record * records = NULL, * more;
+    size_t n = 0, room = 0, i;
+    int sorted = TRUE, ok = TRUE, k;
+
+    if (!parseOpen(&parser, in)) {
+        perror(in);
+        return FALSE;
+    }
+    for (;;) {
+        if (n == room) {
+            room = room ? room * 2 : 4096;
+            if (!(more = realloc(records, room * sizeof(Record)))) {
+                fprintf(stderr, "ERROR - %s: out of memory\n", in);
+                parseClose(&parser);
+                free(records);
+                return FALSE;
+            }
+            records = more;
+        }
+        if (!(k = parseLine(&parser, records[n].fields, JOB_MIN_FIELDS, JOB_FIELDS)))
+            break;
+        while (k < JOB_FIELDS)
+            records[n].fields[k++] = 0;
+        records[n].line = n;
+        if (n && records[n].fields[0] < records[n - 1].fields[0])
+            sorted = FALSE;
+        n++;
+    }
+    parseClose(&parser);
+
+    if (!sorted) {
+        fprintf(stderr, "%s: not in arrival order, sorting\n", in);
+        qsort(records, n, sizeof(Record), CompareArrival);
+    }
+    if (!jobCreate(&writer, out, stride)) {
+        perror(out);
+        free(records);
+        return FALSE;
+    }
+    for (i = 0; i < n && ok; i++)
+        ok = jobAppend(&writer, records[i].fields);
+    if (!jobFinish(&writer) && ok) {
+        perror(out);
+        ok = FALSE;
+    }
+    free(records);
+    fprintf(stderr, "%s: %zu jobs written\n", out, n);
+    return ok && !parser.errors;
+}
+
+/* binary -> text */
+static int ToText(char * in, char * out)
+{
+    JobFile jobs;
+    FILE * stream;
+    int f[JOB_FIELDS], i, last;
+    size_t n;
+
+    if (!jobOpen(&jobs, in))
+        return FALSE;
+    if (!(stream = fopen(out, "w"))) {
+        perror(out);
+        jobClose(&jobs);
+        return FALSE;
+    }
+    for (n = 0; n < jobs.count; n++) {
+        jobRecord(&jobs, n, f);
+        for (last = JOB_FIELDS; last > JOB_MIN_FIELDS && !f[last - 1]; last--);
+        for (i = 0; i < last; i++)
+            fprintf(stream, i ? ", %d" : "%d", f[i]);
+        fputc('\n', stream);
+    }
+    jobClose(&jobs);
+    if (fclose(stream)) {
+        perror(out);
+        return FALSE;
+    }
+    fprintf(stderr, "%s: %zu jobs written\n", out, n);
+    return TRUE;
+}
+
+int main(int argc, char * argv[])
+{
+    char * in = NULL, * out = NULL;
+    int stride = JOB_INDEX_STRIDE;
+    int i = 0, ok;
+
+    while (++i < argc) {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc) {
+            if ((stride = atoi(argv[++i])) < 1)
+                PrintUsage(argv[0]);
+        } else
+        if (!in) {
+            in = argv[i];
+        } else
+        if (!out) {
+            out = argv[i];
+        } else {
+            PrintUsage(argv[0]);
+        }
+    }
+    if (!out) PrintUsage(argv[0]);
+
+    if (jobIsBinary(in))
+        ok = ToText(in, out);
+    else
+        ok = ToBinary(in, out, stride);
+    return ok ? 0 : 1;
+}
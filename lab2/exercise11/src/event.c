@@ -0,0 +1,306 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  event - dispatcher event loop for HOST dispatcher
+
+   The dispatcher used to advance by sleep(QUANTUM), so a tick could
+   not be shorter than a second and a process that ended early left
+   the cpu idle until the sleep ran out. Here the tick is a timerfd
+   of any length, SIGCHLD is delivered through a signalfd, and both
+   are waited on together with epoll.
+
+   int evInit(double tickms)
+      - block SIGCHLD, create the timer, signal and epoll descriptors
+        and start the first tick (tickms milliseconds long)
+    returns:
+      TRUE if ok
+      FALSE if any descriptor could not be created
+
+   int evWait(void)
+      - wait until a tick elapses, a child changes state and/or
+        a descriptor being watched is ready
+    returns:
+      mask of EV_TICK, EV_CHILD, EV_INPUT and EV_OUTPUT
+
+   void evRestartTick(void)
+      - restart the tick timer so that a full tick starts now (used
+        when a process is dispatched part way through a tick)
+    returns NONE
+
+   void evSkip(int ticks)
+      - make the tick under way end ticks ticks after it began rather
+        than one, as one absolute deadline (used to sleep through the
+        ticks up to the next arrival when nothing is running or
+        waiting). evWait reports the end of it as one EV_TICK and the
+        ticks after it are the usual length again. calling it again
+        before then replaces the deadline (it is still counted from
+        the start of the tick)
+    returns NONE
+
+   int evWatch(int fd, int output)
+      - wait for input on fd too, reported by evWait as EV_INPUT, or
+        if output is TRUE for fd to take output (EV_OUTPUT); a
+        descriptor already watched switches from one to the other
+    returns:
+      TRUE if ok
+      FALSE if it could not be added to the epoll set
+
+   void evUnwatch(int fd)
+      - stop waiting on fd (before it is closed)
+    returns NONE
+
+   long long evTickStart(void)
+    returns CLOCK_MONOTONIC (ns) when the tick under way began
+
+   long long evTickLength(void)
+    returns the length of a tick (ns)
+
+   void evPrint(FILE * iostream)
+      - print how late ticks were noticed (and how many overran)
+    returns NONE
+
+   void evClose(void)
+      - close descriptors and restore the signal mask
+    returns NONE
+
+ ********************************************************************
+
+  version: 1.3
+  history:
+     v1.0: timerfd/signalfd/epoll loop replacing sleep(QUANTUM)
+     v1.1: absolute tick deadlines, evSkip
+     v1.2: tick lateness statistics, grid shared with processes (clock.c)
+     v1.3: evWatch/evUnwatch, other descriptors ready for input or
+           output (EV_INPUT, EV_OUTPUT)
+
+ *******************************************************************/
+
+#include "event.h"
+#include "clock.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+
+static int tfd = -1;              // tick timer
+static int sfd = -1;              // SIGCHLD notifications
+static int efd = -1;              // epoll set of the two above (and evWatch's)
+static long long tickns;          // tick length
+static long long startns;         // CLOCK_MONOTONIC when this tick began
+static long long duens;           //  and when it ends (the timer's deadline)
+static sigset_t oldmask;          // signal mask before evInit
+static ClockStats lateness;       // of ticks noticed by evWait
+
+/*******************************************************
+ * static void evArm(long long due)
+ *    - set the tick timer to expire at due, then every tick
+ *******************************************************/
+static void evArm(long long due)
+{
+    struct itimerspec t;
+
+    duens = due;
+    t.it_value.tv_sec = due / CLOCK_NS;
+    t.it_value.tv_nsec = due % CLOCK_NS;
+    t.it_interval.tv_sec = tickns / CLOCK_NS;
+    t.it_interval.tv_nsec = tickns % CLOCK_NS;
+    timerfd_settime(tfd, TFD_TIMER_ABSTIME, &t, NULL);
+}
+
+/*******************************************************
+ * int evInit(double tickms)
+ *    - set up and start the dispatcher event loop
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if any descriptor could not be created
+ *******************************************************/
+int evInit(double tickms)
+{
+    struct epoll_event ev;
+    sigset_t mask;
+
+    tickns = (long long) (tickms * 1000000.0);
+    if (tickns <= 0) tickns = (long long) (DEFAULT_TICK_MS * 1000000.0);
+
+    sigemptyset(&mask);                     // SIGCHLD only via signalfd
+    sigaddset(&mask, SIGCHLD);
+    if (sigprocmask(SIG_BLOCK, &mask, &oldmask) == -1) {
+        perror("evInit sigprocmask");
+        return FALSE;
+    }
+    if ((sfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC)) == -1 ||
+        (tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) == -1 ||
+        (efd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+        perror("evInit");
+        evClose();
+        return FALSE;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.fd = tfd;
+    if (epoll_ctl(efd, EPOLL_CTL_ADD, tfd, &ev) == -1) {
+        perror("evInit epoll_ctl");
+        evClose();
+        return FALSE;
+    }
+    ev.data.fd = sfd;
+    if (epoll_ctl(efd, EPOLL_CTL_ADD, sfd, &ev) == -1) {
+        perror("evInit epoll_ctl");
+        evClose();
+        return FALSE;
+    }
+
+    evRestartTick();
+    return TRUE;
+}
+
+/*******************************************************
+ * int evWait(void)
+ *    - wait for the next dispatcher event(s)
+ *
+ * returns:
+ *    mask of EV_TICK, EV_CHILD, EV_INPUT and EV_OUTPUT
+ *******************************************************/
+int evWait(void)
+{
+    struct epoll_event ev[EV_EVENTS];
+    struct signalfd_siginfo si;
+    uint64_t expirations;
+    int events = 0;
+    int i, n;
+
+    while (!events) {
+        if ((n = epoll_wait(efd, ev, EV_EVENTS, -1)) == -1) {
+            if (errno == EINTR) continue;
+            perror("evWait");
+            return EV_TICK;                 // fall back to free running
+        }
+        for (i = 0; i < n; i++) {
+            if (ev[i].data.fd == tfd) {
+                if (read(tfd, &expirations, sizeof(expirations)) > 0) {
+                    events |= EV_TICK;
+                    startns = duens + (expirations - 1) * tickns;
+                    duens = startns + tickns;
+                    clockLate(&lateness, startns, clockNow(), expirations - 1);
+                }
+            } else if (ev[i].data.fd == sfd) {  // drain all queued SIGCHLDs
+                while (read(sfd, &si, sizeof(si)) == sizeof(si))
+                    events |= EV_CHILD;
+            } else                          // left for the caller
+                events |= ev[i].events & EPOLLOUT ? EV_OUTPUT : EV_INPUT;
+        }
+    }
+    return events;
+}
+
+/*******************************************************
+ * void evRestartTick(void)
+ *    - start a fresh tick from now
+ *
+ * returns NONE
+ *******************************************************/
+void evRestartTick(void)
+{
+    uint64_t expirations;
+
+    if (tfd == -1) return;
+    startns = clockNow();
+    evArm(startns + tickns);
+    while (read(tfd, &expirations, sizeof(expirations)) > 0);  // discard stale tick
+}
+
+/*******************************************************
+ * void evSkip(int ticks)
+ *    - end the tick under way ticks ticks after it began
+ *
+ * returns NONE
+ *******************************************************/
+void evSkip(int ticks)
+{
+    if (tfd == -1 || ticks < 1) return;
+    evArm(startns + ticks * tickns);
+}
+
+/*******************************************************
+ * int evWatch(int fd, int output)
+ *    - add fd to the descriptors waited on, for input or output
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if not
+ *******************************************************/
+int evWatch(int fd, int output)
+{
+    struct epoll_event ev;
+
+    ev.events = output ? EPOLLOUT : EPOLLIN;
+    ev.data.fd = fd;
+    if (efd == -1)
+        return FALSE;
+    return epoll_ctl(efd, EPOLL_CTL_ADD, fd, &ev) == 0 ||
+           (errno == EEXIST && epoll_ctl(efd, EPOLL_CTL_MOD, fd, &ev) == 0);
+}
+
+/*******************************************************
+ * void evUnwatch(int fd)
+ *    - take fd out of the descriptors waited on
+ *
+ * returns NONE
+ *******************************************************/
+void evUnwatch(int fd)
+{
+    if (efd != -1)
+        epoll_ctl(efd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+/*******************************************************
+ * long long evTickStart(void)
+ *
+ * returns when the tick under way began (ns)
+ *******************************************************/
+long long evTickStart(void)
+{
+    return startns;
+}
+
+/*******************************************************
+ * long long evTickLength(void)
+ *
+ * returns the tick length (ns)
+ *******************************************************/
+long long evTickLength(void)
+{
+    return tickns;
+}
+
+/*******************************************************
+ * void evPrint(FILE * iostream)
+ *    - print tick lateness statistics
+ *
+ * returns NONE
+ *******************************************************/
+void evPrint(FILE * stream)
+{
+    clockPrint(&lateness, "dispatcher clock", stream);
+}
+
+/*******************************************************
+ * void evClose(void)
+ *    - release event loop descriptors
+ *
+ * returns NONE
+ *******************************************************/
+void evClose(void)
+{
+    if (efd != -1) close(efd);
+    if (tfd != -1) close(tfd);
+    if (sfd != -1) close(sfd);
+    efd = tfd = sfd = -1;
+    sigprocmask(SIG_SETMASK, &oldmask, NULL);
+}
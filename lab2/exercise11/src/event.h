@@ -0,0 +1,68 @@
+#ifndef EVENT_H
+#define EVENT_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  event - dispatcher event loop for HOST dispatcher
+
+  int evInit(double tickms) - set up tick timer, SIGCHLD trap and epoll
+  int evWait(void) - wait for the next dispatcher event(s)
+  void evRestartTick(void) - start a fresh tick from now
+  void evSkip(int ticks) - make the tick under way ticks long
+  int evWatch(int fd, int output) - wait for fd to take input (EV_INPUT)
+      or output (EV_OUTPUT) too
+  void evUnwatch(int fd) - stop waiting on fd
+  long long evTickStart(void) - when the tick under way began
+  long long evTickLength(void) - length of a tick
+  void evPrint(FILE * iostream) - print tick lateness statistics
+  void evClose(void) - release event loop descriptors
+
+  see event.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.3
+  history:
+     v1.0: timerfd/signalfd/epoll loop replacing sleep(QUANTUM)
+     v1.1: absolute tick deadlines, evSkip
+     v1.2: tick lateness statistics, grid shared with processes (clock.c)
+     v1.3: evWatch/evUnwatch, other descriptors ready for input or
+           output (EV_INPUT, EV_OUTPUT)
+
+ *******************************************************************/
+
+#include <stdio.h>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+/* event loop definitions *************************************/
+
+#define DEFAULT_TICK_MS 1000.0  /* length of one dispatcher tick */
+
+#define EV_TICK   0x01          /* a dispatcher tick has elapsed */
+#define EV_CHILD  0x02          /* a child process changed state */
+#define EV_INPUT  0x04          /* input on a watched descriptor */
+#define EV_OUTPUT 0x08          /* a watched descriptor takes output */
+#define EV_EVENTS 16            /* epoll events taken at a time */
+
+/* event loop prototypes *************************************/
+
+int  evInit(double);
+int  evWait(void);
+void evRestartTick(void);
+void evSkip(int);
+int  evWatch(int, int);
+void evUnwatch(int);
+long long evTickStart(void);
+long long evTickLength(void);
+void evPrint(FILE *);
+void evClose(void);
+
+#endif
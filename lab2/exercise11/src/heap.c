@@ -0,0 +1,302 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  heap - priority queue of processes for HOST dispatcher
+
+   A binary min-heap of PcbPtrs in a growing array, ordered by a
+   'before' function given when the heap is made empty. Push and pop
+   are O(log n), top is O(1). Equal processes are not kept in any
+   particular order by the heap itself, so a 'before' function that
+   needs a stable order should fall back on the pcb's seq.
+
+   void initPcbHeap (PcbHeapPtr h, PcbBefore before)
+      - make h empty, ordered by before(a, b) (TRUE if a comes first)
+    returns NONE
+
+   PcbPtr pushPcbHeap (PcbHeapPtr h, PcbPtr process)
+      - add process to h
+    returns:
+      process
+      NULL if the heap could not grow
+
+   PcbPtr popPcbHeap (PcbHeapPtr h)
+      - remove the first process from h
+    returns:
+      PcbPtr of process removed
+      NULL if h was empty
+
+   PcbPtr rmPcbHeap (PcbHeapPtr h, int n)
+      - remove h->item[n] from h, in O(log n)
+    returns:
+      PcbPtr of process removed
+      NULL if n is not on h
+
+   PcbPtr topPcbHeap (PcbHeapPtr h)
+    returns:
+      PcbPtr of the first process (left on h)
+      NULL if h is empty
+
+   void reorderPcbHeap (PcbHeapPtr h)
+      - restore the heap order of h after the order given by its
+        'before' function has changed (it may depend on the time, see
+        hostd's response ratio), in O(n)
+    returns NONE
+
+   void freePcbHeap (PcbHeapPtr h)
+      - release the array (not the processes still on h) and make h
+        empty
+    returns NONE
+
+   int pcbArrivesBefore (PcbPtr a, PcbPtr b)
+    returns:
+      TRUE if a arrives before b, or at the same time and came first
+      in the dispatch file(s) (lower seq)
+
+   int pcbShorterRemaining (PcbPtr a, PcbPtr b)
+    returns:
+      TRUE if a has less cpu time left to run than b, or as much and
+      came first in the dispatch file(s)
+
+   int pcbDeadlineBefore (PcbPtr a, PcbPtr b)
+    returns:
+      TRUE if a must end before b (one without a deadline comes after
+      any with one), or by the same time and arrives before b
+
+   int pcbPassBefore (PcbPtr a, PcbPtr b)
+    returns:
+      TRUE if a has the lower stride scheduling pass, or the same and
+      came first in the dispatch file(s)
+
+ ********************************************************************
+
+  version: 1.3
+  history:
+     v1.0: binary min-heap, input queue ordered by arrival time
+     v1.1: reorderPcbHeap, pcbShorterRemaining for user job policies
+     v1.2: rmPcbHeap, pcbPassBefore
+     v1.3: pcbDeadlineBefore
+
+ *******************************************************************/
+
+#include "heap.h"
+
+static void siftUp(PcbHeapPtr, int, PcbPtr);
+static void siftDown(PcbHeapPtr, int, PcbPtr);
+
+/*******************************************************
+ * void initPcbHeap (PcbHeapPtr h, PcbBefore before) - make h empty
+ *******************************************************/
+
+void initPcbHeap(PcbHeapPtr h, PcbBefore before)
+{
+    h->item = NULL;
+    h->length = h->room = 0;
+    h->before = before;
+}
+
+/*******************************************************
+ * PcbPtr pushPcbHeap (PcbHeapPtr h, PcbPtr process)
+ *    - add process to h
+ *
+ * returns:
+ *    process
+ *    NULL if the heap could not grow
+ *******************************************************/
+
+PcbPtr pushPcbHeap(PcbHeapPtr h, PcbPtr p)
+{
+    PcbPtr * item;
+    int n;
+
+    if (h->length == h->room) {
+        n = h->room ? h->room * 2 : 64;
+        if (!(item = realloc(h->item, n * sizeof(PcbPtr)))) {
+            perror("growing process heap");
+            return NULL;
+        }
+        h->item = item;
+        h->room = n;
+    }
+    siftUp(h, h->length++, p);  // from the new leaf
+    return p;
+}
+
+/*******************************************************
+ * PcbPtr popPcbHeap (PcbHeapPtr h)
+ *    - remove the first process from h
+ *
+ * returns:
+ *    PcbPtr of process removed
+ *    NULL if h was empty
+ *******************************************************/
+
+PcbPtr popPcbHeap(PcbHeapPtr h)
+{
+    PcbPtr first, last;
+
+    if (!h->length)
+        return NULL;
+    first = h->item[0];
+    last = h->item[--h->length];
+    if (h->length)
+        siftDown(h, 0, last);   // the last leaf, down from the root
+    return first;
+}
+
+/*******************************************************
+ * PcbPtr rmPcbHeap (PcbHeapPtr h, int n)
+ *    - remove h->item[n] from h
+ *
+ * returns:
+ *    PcbPtr of process removed
+ *    NULL if there is no item[n]
+ *******************************************************/
+
+PcbPtr rmPcbHeap(PcbHeapPtr h, int n)
+{
+    PcbPtr p, last;
+
+    if (n < 0 || n >= h->length)
+        return NULL;
+    p = h->item[n];
+    last = h->item[--h->length];
+    if (n < h->length) {        // the last leaf goes up or down from n
+        if (n > 0 && h->before(last, h->item[(n - 1) / 2]))
+            siftUp(h, n, last);
+        else
+            siftDown(h, n, last);
+    }
+    return p;
+}
+
+/*******************************************************
+ * PcbPtr topPcbHeap (PcbHeapPtr h)
+ *
+ * returns:
+ *    PcbPtr of the first process
+ *    NULL if h is empty
+ *******************************************************/
+
+PcbPtr topPcbHeap(PcbHeapPtr h)
+{
+    return h->length ? h->item[0] : NULL;
+}
+
+/*******************************************************
+ * void reorderPcbHeap (PcbHeapPtr h) - heap h afresh
+ *******************************************************/
+
+void reorderPcbHeap(PcbHeapPtr h)
+{
+    int n;
+
+    // sift down every parent, the last first (Floyd)
+    for (n = h->length / 2 - 1; n >= 0; n--)
+        siftDown(h, n, h->item[n]);
+}
+
+/*******************************************************
+ * void freePcbHeap (PcbHeapPtr h) - release the array
+ *******************************************************/
+
+void freePcbHeap(PcbHeapPtr h)
+{
+    free(h->item);
+    initPcbHeap(h, h->before);
+}
+
+/*******************************************************
+ * int pcbArrivesBefore (PcbPtr a, PcbPtr b)
+ *
+ * returns:
+ *    TRUE if a arrives first (by time, then by seq)
+ *******************************************************/
+
+int pcbArrivesBefore(PcbPtr a, PcbPtr b)
+{
+    if (a->arrivaltime != b->arrivaltime)
+        return a->arrivaltime < b->arrivaltime;
+    return a->seq < b->seq;
+}
+
+/*******************************************************
+ * int pcbShorterRemaining (PcbPtr a, PcbPtr b)
+ *
+ * returns:
+ *    TRUE if a has less left to run (then by seq)
+ *******************************************************/
+
+int pcbShorterRemaining(PcbPtr a, PcbPtr b)
+{
+    if (a->remainingcputime != b->remainingcputime)
+        return a->remainingcputime < b->remainingcputime;
+    return a->seq < b->seq;
+}
+
+/*******************************************************
+ * int pcbDeadlineBefore (PcbPtr a, PcbPtr b)
+ *
+ * returns:
+ *    TRUE if a has the earlier deadline (then by arrival)
+ *******************************************************/
+
+int pcbDeadlineBefore(PcbPtr a, PcbPtr b)
+{
+    if (a->deadline != b->deadline)
+        return a->deadline < b->deadline;
+    return pcbArrivesBefore(a, b);
+}
+
+/*******************************************************
+ * int pcbPassBefore (PcbPtr a, PcbPtr b)
+ *
+ * returns:
+ *    TRUE if a has the lower pass (then by seq)
+ *******************************************************/
+
+int pcbPassBefore(PcbPtr a, PcbPtr b)
+{
+    if (a->pass != b->pass)
+        return a->pass < b->pass;
+    return a->seq < b->seq;
+}
+
+/*******************************************************
+ * void siftUp (PcbHeapPtr h, int n, PcbPtr p)
+ *    - put p at item[n] or above it, moving down the
+ *      parents it comes before
+ *******************************************************/
+
+static void siftUp(PcbHeapPtr h, int n, PcbPtr p)
+{
+    int parent;
+
+    for (; n > 0; n = parent) {
+        parent = (n - 1) / 2;
+        if (!h->before(p, h->item[parent]))
+            break;
+        h->item[n] = h->item[parent];
+    }
+    h->item[n] = p;
+}
+
+/*******************************************************
+ * void siftDown (PcbHeapPtr h, int n, PcbPtr p)
+ *    - put p at item[n] or below it, moving up the
+ *      children that come before it
+ *******************************************************/
+
+static void siftDown(PcbHeapPtr h, int n, PcbPtr p)
+{
+    int child;
+
+    for (; (child = 2 * n + 1) < h->length; n = child) {
+        if (child + 1 < h->length && h->before(h->item[child + 1], h->item[child]))
+            child++;
+        if (!h->before(h->item[child], p))
+            break;
+        h->item[n] = h->item[child];
+    }
+    h->item[n] = p;
+}
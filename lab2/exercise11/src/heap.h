@@ -0,0 +1,64 @@
+#ifndef HEAP_H
+#define HEAP_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  heap - priority queue of processes for HOST dispatcher
+
+  void initPcbHeap (PcbHeapPtr h, PcbBefore before) - make h empty
+  PcbPtr pushPcbHeap (PcbHeapPtr h, PcbPtr process) - add process
+  PcbPtr popPcbHeap (PcbHeapPtr h) - remove the first process
+  PcbPtr rmPcbHeap (PcbHeapPtr h, int n) - remove h->item[n]
+  PcbPtr topPcbHeap (PcbHeapPtr h) - look at the first process
+  void reorderPcbHeap (PcbHeapPtr h) - restore order after it changed
+  void freePcbHeap (PcbHeapPtr h) - release the heap's array
+
+  int pcbArrivesBefore (PcbPtr a, PcbPtr b) - order by arrival time
+  int pcbShorterRemaining (PcbPtr a, PcbPtr b) - order by cpu time left
+  int pcbPassBefore (PcbPtr a, PcbPtr b) - order by stride pass
+  int pcbDeadlineBefore (PcbPtr a, PcbPtr b) - order by deadline
+
+  see heap.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.3
+  history:
+     v1.0: binary min-heap, input queue ordered by arrival time
+     v1.1: reorderPcbHeap, pcbShorterRemaining for user job policies
+     v1.2: rmPcbHeap, pcbPassBefore
+     v1.3: pcbDeadlineBefore
+
+ *******************************************************************/
+
+#include "pcb.h"
+
+/* heap definitions ********************************************/
+
+struct pcbheap {
+    PcbPtr * item;             // item[0] is first, children of n at 2n+1, 2n+2
+    int length;
+    int room;                  // items allocated
+    PcbBefore before;          // ordering
+};
+
+typedef struct pcbheap PcbHeap;
+typedef PcbHeap * PcbHeapPtr;
+
+/* heap prototypes *********************************************/
+
+void   initPcbHeap(PcbHeapPtr, PcbBefore);
+PcbPtr pushPcbHeap(PcbHeapPtr, PcbPtr);
+PcbPtr popPcbHeap(PcbHeapPtr);
+PcbPtr rmPcbHeap(PcbHeapPtr, int);
+PcbPtr topPcbHeap(PcbHeapPtr);
+void   reorderPcbHeap(PcbHeapPtr);
+void   freePcbHeap(PcbHeapPtr);
+
+int    pcbArrivesBefore(PcbPtr, PcbPtr);
+int    pcbShorterRemaining(PcbPtr, PcbPtr);
+int    pcbPassBefore(PcbPtr, PcbPtr);
+int    pcbDeadlineBefore(PcbPtr, PcbPtr);
+
+#endif
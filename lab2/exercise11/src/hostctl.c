@@ -0,0 +1,188 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  hostctl - submit jobs to a running HOST dispatcher
+
+  usage:
+
+    hostctl [-s socket] [-b] [-x] [file ...]
+
+  the dispatch file lines in the files (or standard input) are sent
+  in one batch to the socket of a dispatcher started with --listen
+  (default hostd.sock), and its acknowledgement, a "queued <id> <job>"
+  line for each job then "done <queued> <rejected>", is printed. -b
+  parses the lines here and sends them as binary records instead, so
+  the dispatcher has nothing to parse. -x sends no jobs but tells the
+  dispatcher to close its socket and end once its jobs are done.
+  each job arrives when the dispatcher reads the batch; the first
+  field of a line (its arrival time) is ignored.
+
+  returns 0 if every job was queued, 1 if any was rejected, 2 if the
+  dispatcher could not be reached
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: text and binary batches, -x shutdown
+
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "submit.h"
+
+#define DEFAULT_NAME "hostctl"
+
+static void PrintUsage(char * progname)
+{
+    fprintf(stderr, "usage: %s [-s socket] [-b] [-x] [file ...]\n",
+        progname ? progname : DEFAULT_NAME);
+    exit(127);
+}
+
+/* append size bytes to the batch */
+static void Append(char ** batch, size_t * size, size_t * room,
+                   const void * data, size_t n)
+{
+    while (*size + n > *room) {
+        *room = *room ? 2 * *room : 4096;
+        if (!(*batch = realloc(*batch, *room))) {
+            perror(DEFAULT_NAME);
+            exit(2);
+        }
+    }
+    memcpy(*batch + *size, data, n);
+    *size += n;
+}
+
+/* read a whole stream into the batch */
+static int ReadStream(FILE * in, char ** batch, size_t * size, size_t * room)
+{
+    char buffer[65536];
+    size_t n;
+
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        Append(batch, size, room, buffer, n);
+    return !ferror(in);
+}
+
+/* text -> binary records, JOB_MAGIC and a field count first */
+static char * Binary(char * text, size_t length, size_t * size, int * errors)
+{
+    char * batch = NULL;
+    size_t room = 0;
+    uint32_t fields = JOB_FIELDS;
+    int32_t record[JOB_FIELDS];
+    int f[JOB_FIELDS], n, i;
+    Parser p;
+
+    *size = 0;
+    Append(&batch, size, &room, JOB_MAGIC, sizeof(JOB_MAGIC) - 1);
+    Append(&batch, size, &room, &fields, sizeof(fields));
+    parseBuffer(&p, "input", text, length);
+    while ((n = parseLine(&p, f, JOB_MIN_FIELDS, JOB_FIELDS))) {
+        for (i = 0; i < JOB_FIELDS; i++)
+            record[i] = i < n ? f[i] : 0;
+        Append(&batch, size, &room, record, sizeof(record));
+    }
+    *errors = p.errors;
+    parseClose(&p);             // frees text
+    return batch;
+}
+
+int main(int argc, char * argv[])
+{
+    struct sockaddr_un addr;
+    char * path = SUBMIT_PATH, * batch = NULL, reply[4096];
+    size_t size = 0, room = 0, sent;
+    int binary = FALSE, shutdown_ = FALSE, errors = 0, queued = -1, rejected = 0;
+    int fd, i, files = 0;
+    ssize_t n;
+    FILE * in;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            path = argv[++i];
+        else if (!strcmp(argv[i], "-b"))
+            binary = TRUE;
+        else if (!strcmp(argv[i], "-x"))
+            shutdown_ = TRUE;
+        else if (argv[i][0] == '-' && argv[i][1])
+            PrintUsage(argv[0]);
+        else {
+            files++;
+            if (shutdown_)
+                continue;
+            if (!(in = strcmp(argv[i], "-") ? fopen(argv[i], "r") : stdin) ||
+                !ReadStream(in, &batch, &size, &room)) {
+                perror(argv[i]);
+                exit(2);
+            }
+            if (in != stdin)
+                fclose(in);
+        }
+    }
+    if (shutdown_) {
+        size = 0;
+        Append(&batch, &size, &room, SUBMIT_SHUTDOWN "\n",
+            strlen(SUBMIT_SHUTDOWN "\n"));
+    } else {
+        if (!files && !ReadStream(stdin, &batch, &size, &room)) {
+            perror("stdin");
+            exit(2);
+        }
+        if (binary)
+            batch = Binary(batch, size, &size, &errors);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", path);
+        exit(2);
+    }
+    strcpy(addr.sun_path, path);
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1 ||
+        connect(fd, (struct sockaddr *) &addr, sizeof(addr)) == -1) {
+        perror(path);
+        exit(2);
+    }
+    for (sent = 0; sent < size; sent += n)   // the whole batch, then EOF
+        if ((n = write(fd, batch + sent, size - sent)) <= 0) {
+            perror(path);
+            exit(2);
+        }
+    shutdown(fd, SHUT_WR);
+    free(batch);
+
+    // print the acknowledgement, noting its last line's counts
+    size = 0;
+    while ((n = read(fd, reply + size, sizeof(reply) - 1 - size)) > 0) {
+        char * line, * end;
+
+        size += n;
+        reply[size] = '\0';
+        for (line = reply; (end = strchr(line, '\n')); line = end + 1) {
+            *end = '\0';
+            puts(line);
+            sscanf(line, "done %d %d", &queued, &rejected);
+        }
+        size = strlen(line);
+        memmove(reply, line, size);
+    }
+    close(fd);
+    if (shutdown_)
+        return 0;
+    if (queued < 0) {
+        fprintf(stderr, "%s: no acknowledgement\n", path);
+        return 2;
+    }
+    return rejected || errors ? 1 : 0;
+}
@@ -12,67 +12,307 @@ OS Eercises - Project 2 - HOST dispatcher - Exercise 11 and project final
         command line and the jobs are simulatred by executing the 'process'
         program provided.
 
+        several dispatch files may be given; their jobs are merged on an
+        input queue ordered by arrival time (a heap), so the files need
+        not be sorted. jobs arriving together are taken in the order of
+        the files on the command line, then of the lines in each file.
+
+        --listen socket takes jobs while running as well, from a unix
+        domain socket (submit.c) that hostctl writes batches of dispatch
+        file lines (or binary records) to. the dispatch files are then
+        optional and answers go to <socket>.ans. a submitted job arrives
+        at the tick it is read in, whatever its first field says, and
+        the batch is acknowledged with each job's id and name. hostd
+        carries on, without fast-forwarding idle ticks, until hostctl
+        -x closes the socket and every job has run.
+
         The dispatcher implements memory and i/o resource allocation.
 
-        time resolution is one second (although this can be changed).
+        time resolution is one tick of one second by default; the tick
+        length can be set with -t (milliseconds, fractions allowed).
+        ticks come from a timerfd and child state changes from a
+        signalfd, both waited on with epoll, so a process that ends
+        on its own is replaced without waiting for the tick to run out.
+
+        with --simulate no process is forked and nothing waits: the
+        same policies run on a virtual clock and the answer file gets
+        the lines the 'process' program would have written.
+
+        -c N dispatches onto N virtual cpus, each with its own running
+        process, time-slice and feedback queues. real-time processes
+        share one queue and preempt the lowest priority user process
+        when no cpu is idle. as many may run at once as there are
+        cpus, so RT_MEMORY_SIZE is reserved for each cpu and user
+        jobs are limited to what is left. a new user process is queued on the least
+        loaded cpu and a suspended one goes back on the cpu it ran on;
+        a cpu with nothing to run steals from the tail of the busiest
+        other cpu's queues.
+
+        -b backfills the user job queue (EASY backfilling): when the job
+        at its head can't get its memory or i/o resources, later jobs
+        that fit now are admitted past it as long as they are not
+        expected to hold it up. the cpus are assumed shared equally
+        among everything running or queued (processor sharing) to
+        estimate when each admitted job ends from its remaining cpu
+        time. releasing their memory and i/o resources in that order
+        gives the head's 'shadow' time, the earliest it could start.
+        a later job is admitted if it is expected to end by then, or
+        if what it holds leaves enough for the head at that time.
+
+        -p N keeps N 'process' workers forked, exec'd and parked on a
+        pipe (worker.c). a job dispatched for the first time is handed
+        to one of them instead of being forked, and the pool is topped
+        up again before waiting for the next tick.
+
+        -a N lets a context switch run ahead of the stop it asks for:
+        a process being suspended is sent SIGTSTP and the next one is
+        started or continued straight away, the stop being seen later
+        when its SIGCHLD arrives (or before the process is continued
+        again). at most N processes are ever running on a cpu, the
+        one dispatched and N - 1 still on their way to stopping; past
+        that a suspend waits for the stop as before. with N > 1 the
+        SIGTSTP line of one process and the START or SIGCONT line of
+        the next can be written to the answer file in either order.
+
+        the user job feedback queues are set at run time: -l N levels
+        (1 is plain round robin), each with its own time-slice (-q, for
+        instance 1,2,4 doubling at each level, the last one given
+        holding for any levels after it). a job given a priority below
+        the lowest level starts on the lowest. -B S boosts every user
+        job, queued or running, back to the highest level every S
+        ticks so that long jobs demoted to the bottom are not starved
+        by a steady stream of new ones.
+
+        -u srtf or -u hrrn takes the user jobs off the feedback queues
+        and puts them on one heap shared by all cpus, ordered by the
+        cpu time they have left (shortest remaining time first) or by
+        their response ratio, (time since arrival + time left) / time
+        left (highest response ratio next). the response ratio grows
+        as a job waits, so that heap is put back in order before jobs
+        are taken from it. with srtf a job arriving with less to do
+        than one running preempts the one with the most left; with
+        hrrn a job runs until it ends. either way real-time processes
+        still come first, in arrival order, and preempt the user job
+        the policy would have run last.
+
+        -u stride and -u lottery share the cpus among user jobs in
+        proportion to their tickets (the ninth field of a dispatch
+        file line, or 100 for the lowest priority doubling at each
+        level above). with stride each job's pass grows by STRIDE1 /
+        tickets for every tick it runs and at the end of a time-slice
+        the job with the lowest pass runs next, taken from the heap
+        in O(log n). a job admitted starts from the pass of the last
+        job taken. with lottery a ticket is drawn at the end of every
+        time-slice, among the running job and those waiting, and its
+        holder runs next (a draw walks the heap, O(n)). -s compares
+        the cpu time jobs of each ticket count had with their share of
+        it in proportion to the tickets admitted at the time.
+
+        -u cfs is a completely fair scheduler: user jobs wait in a
+        red-black tree (rbtree.c) ordered by virtual runtime, which
+        grows by STRIDE1 / tickets for every tick a job runs, so
+        tickets act as its weight. the job with the least virtual
+        runtime, cached as the tree's leftmost, runs next. its time-
+        slice is its weighted share of a period of -L ticks (the
+        target latency) in which every job runnable should run once,
+        the period stretching to -g ticks (the minimum granularity)
+        for each job when there are more jobs than that allows. at
+        the end of a slice the job carries on if it still has the
+        least virtual runtime. a job admitted starts from the
+        greatest virtual runtime a job taken to run has had, so it
+        neither owes nor is owed time. the tree is shared by
+        all cpus, each taking the leftmost job when it is idle.
+
+        a real-time job may be given a deadline, the tenth field of its
+        line (after the tickets, 0 for the default): the ticks from its
+        arrival it must end within. the real-time queue is kept in
+        order of deadline (earliest deadline first), jobs without one
+        after those with one and jobs due together in order of arrival,
+        which without deadlines is the first-come-first-served order it
+        always had. a real-time job with an earlier deadline than one
+        running preempts the one with the latest when no cpu is idle or
+        running a user job. a job with a deadline is only admitted if
+        every deadline from its own on can still be met: the real-time
+        jobs with deadlines, running or queued, and the new one are run
+        in a model of earliest deadline first on all the cpus, and one
+        that would make any of them end late is rejected on arrival.
+        (on one cpu this is the cpu time each and those before it still
+        need fitting in the time to its deadline; on more, that alone
+        would admit sets that miss.) a job that ends after its deadline
+        anyway is reported on stderr, and -s gives the spread of
+        lateness (end less deadline) and the misses.
+
+        every job's pcb keeps the times it was admitted and first
+        dispatched, and the ticks it has spent ready but not running
+        (from arrival to its first dispatch and from each suspend to
+        the resume after it). when it ends its turnaround (arrival to
+        end), waiting, response (arrival to first dispatch) and
+        admission (arrival to admission) times are counted for its
+        priority tier (as given in the dispatch file) and for all jobs,
+        in log-linear histograms (latency.c) that stay the same size
+        however many jobs run. -s prints the mean, p50, p95, p99 and
+        max of each, to compare policies, and -H writes each
+        histogram's percentile distribution to a file in
+        HdrHistogram's text format.
+
+        --trace file writes the dispatch timeline as trace event JSON
+        (trace.c) for chrome://tracing or ui.perfetto.dev: a track for
+        each cpu holding a duration event for every interval a job
+        runs there, with instant events for its START, SIGCONT,
+        SIGTSTP and SIGINT (or its end on its own), and counter tracks
+        for the length of each queue, the free memory, largest free
+        block and free blocks, and the i/o resources available.
+        timestamps are wall-clock microseconds from the start, or
+        when simulating the timer times the tick length. events are
+        buffered a megabyte at a time and counters only written when
+        they change, so tracing takes little from the dispatcher.
+
+        --metrics file writes the dispatcher's state every -M ticks
+        (default 1) and on exit, in the Prometheus text format, for a
+        local scraper (a node exporter textfile collector, say) to
+        read while it runs: queue depths by queue and priority level,
+        jobs admitted, rejected and completed, dispatches and context
+        switches, free memory, largest free block and fragmentation
+        from the memory arena, the i/o resources available, and the
+        time spent in each phase of the loop (i and ii, iii, iv, v).
+        the metrics go to file.tmp, renamed to file once written, so
+        a reader only ever sees a whole set of them.
+
+        -ls starts a job with posix_spawn (launch.c) rather than fork
+        and exec (-lf), so the dispatcher's address space is not
+        copied, the answer file is opened for the job by a spawn file
+        action and its PCB line is printed by the dispatcher. however
+        it was started, a job is signalled and waited for through a
+        pidfd, never by a pid that could have been reused.
 
         for more details of operarion see the specifications for the second
         project
 
     usage
 
-        hostd [-mf|-mn|-mb|-mw] <dispatch file>
+        hostd [-mf|-mn|-mb|-mw] [-mnr] [-lf|-ls] [-a N] [-b] [-c N] [-p N]
+              [-u fb|srtf|hrrn|stride|lottery|cfs] [-L ticks] [-g ticks]
+              [-l N] [-q q1,q2,..] [-B S] [-t ms] [-w ticks] [-s] [-H file]
+              [--trace file] [--metrics file] [-M ticks] [--listen socket]
+              [--simulate] <dispatch file> [<dispatch file> ...]
 
         where
             <dispatch file> is list of process parameters as specified
-                for assignment 2.
+                for assignment 2, as text or in the binary form written
+                by hostd-convert (recognised by its header). answers
+                go to <first dispatch file>.ans
+                (optional with --listen)
             -mx is optional selection of memory allocation algorithm
                 -mf First Fit (default)
                 -mn Next Fit
                 -mb Best Fit
                 -mw Worst Fit
+            -mnr don't preallocate real-time memory
+            -lx is optional selection of how jobs are started
+                -lf fork and exec (default)
+                -ls posix_spawn
+            -a N is the most jobs running on a cpu at once, 1 (the default)
+                waits for each suspended job to stop before starting the next
+            -b backfill the user job queue
+            -c N is the number of cpus (default 1)
+            -p N is the number of parked workers (default 0, fork each
+                job when it first runs)
+            -u is how user jobs are chosen to run
+                fb per-cpu feedback queues (default)
+                srtf shortest remaining time first
+                hrrn highest response ratio next
+                stride stride scheduling by tickets
+                lottery lottery scheduling by tickets
+                cfs completely fair scheduling weighted by tickets
+            -L ticks is the cfs target latency (default 6)
+            -g ticks is the cfs minimum granularity (default 1)
+            -l N is the number of user job feedback levels (default 3,
+                at most 31)
+            -q q1,q2,.. are the time-slices of the feedback levels in
+                ticks, highest level first (default 1 for every level)
+            -B S boosts every user job to the highest level every S ticks
+                (default 0, never)
+            -t ms is the length of a dispatcher tick in milliseconds
+                (default 1000), and of the ticks of the processes it
+                starts
+            -w ticks is how far ahead of the timer jobs are read from the
+                dispatch file (default 8)
+            -s prints dispatcher statistics on exit (utilisation,
+                admission waits, backfilled jobs, switch latency,
+                job latencies, ..)
+            -H file writes the job latency histograms to file
+            --trace file writes a trace of the dispatch timeline to file
+            --metrics file writes live metrics to file
+            -M ticks is how often the metrics are written (default 1)
+            --listen socket takes jobs submitted to a unix socket too
+            --simulate runs on a virtual clock without child processes
 
     functionality
 
     1. Initialize  all dispatcher queues;
     2. Initialise memory and resource allocation structures;
-    3. Fill dispatcher queue from dispatch list file;
-    4. Start dispatcher timer;
-    5. While there's anything in any of the queues or there is a currently running process:
+    3. Open dispatch list files (jobs are read into the input queue a
+       lookahead window ahead of the timer at the start of each pass,
+       or all at once from a file that is not in arrival order);
+    4. Start dispatcher timer (virtual when simulating);
+    5. While there's anything left in the dispatch file or in any of the queues
+       or there is a process running on any cpu:
         i. Unload any pending processes from the input queue:
-           While (head-of-input-queue.arrival-time <= dispatcher timer)
-           dequeue process from input queue and enqueue on either:
-            a. Real-time queue or
+           While (earliest-of-input-queue.arrival-time <= dispatcher timer)
+           pop process from input queue and enqueue on either:
+            a. Real-time queue (in deadline order, if its deadline can be met) or
             b. User job queue;
        ii. Unload pending processes from the user job queue:
            While (head-of-user-job-queue.mbytes can be allocated)
             a. dequeue process from user job queue,
             b. allocate memory to the process,
             c. allocate i/o resources to the process, and
-            d. enqueue on appropriate priority feedback queue;
-      iii. If a process is currently running:
+            d. enqueue on appropriate priority feedback queue (-u: on
+              the user job heap);
+           then with -b, admit later jobs that fit and won't hold up
+           the head of the user job queue (see above);
+      iii. For each cpu, if a process is currently running:
             a. Decrement process remainingcputime;
             b. If times up:
                 A. Send SIGINT to the process to terminate it;
                 B. Free memory and i/o resources we have allocated to the process (user job only);
                 C. Free up process structure memory;
-            c. else if it is a user process and other processes are waiting in any of the queues:
-                A. Send SIGTSTP to suspend it;
+            c. else if it is a user process (-u fb) and more processes are waiting in the
+               queues than there are idle cpus:
+                A. Send SIGTSTP to suspend it (-a: without waiting for it to stop);
                 B. Reduce the priority of the process (if possible) and enqueue it on
                    the appropriate feedback queue;
-       iv. If no process currently running && real time queue and feedback queues are not all empty:
-            a. Dequeue process from the highest priority queue that is not empty
+           then (-B) every S ticks move every user job to the highest level;
+       iv. For each cpu with no process running && real time queue and feedback
+           queues are not all empty:
+            a. Dequeue process from the real time queue or the cpu's own highest
+               priority queue that is not empty (or steal one from the busiest cpu;
+               -u: the first on the user job heap)
             b. If already started but suspended, restart it (send SIGCONT to it)
                else start it (fork & exec)
             c. Set it as currently running process;
-        v. sleep for one second;
+           While real time processes are waiting and a cpu runs a user process,
+           suspend the lowest priority one (holding its priority) and start the
+           real time process there; while the first waiting real time process
+           has an earlier deadline than one running, suspend the one with the
+           latest deadline and start the waiting one there; then (-u srtf) while the first user job on
+           the heap has less left to run than one running, swap it in for the
+           one running with the most left;
+        v. wait for the next event (when nothing is running or waiting,
+           the wait is for the tick the next job arrives in rather than
+           tick by tick, and simulation jumps straight to it):
+            a. a suspended child that has stopped is noted (-a) and one
+               that ended on its own is reaped, its resources are
+               freed and steps i, ii and iv run again straight away
+               (restarting the tick if a process was dispatched);
+            b. a tick ends the wait (simulation: a tick passes at once);
        vi. Increment dispatcher timer;
       vii. Go back to 5.
     6. Exit
 
 ********************************************************************
 
-version: 1.4 (exercise 11 and project final)
+version: 1.28
 date:    December 2003
 author:  Dr Ian G Graham, ian.graham@griffith.edu.au
 history:
@@ -83,11 +323,51 @@ history:
    v1.3: Add memory block allocation (exercise 10)
    v1.4: Add resource allocation and merge real-time and feedback
          dispatcher operation (exercise 11 and project final)
+   v1.5: Event driven loop (timerfd/signalfd/epoll) with sub-second
+         ticks; react to SIGCHLD straight away
+   v1.6: --simulate: virtual clock, no child processes
+   v1.7: -c N virtual cpus, CountQueues/IdleCpus/PreemptCpu/Dispatch fns
+   v1.8: per-cpu feedback queues with work stealing, -s statistics
+   v1.9: O(1) queues with a non-empty bitmap, CheckQueues/CountQueues
+         replaced by topPcbLevel/countPcbLevels
+   v1.10: pcbs and memory blocks from pools, released in bulk at exit
+   v1.11: dispatch file read incrementally (loader.c), -w lookahead
+   v1.12: binary dispatch files (jobfile.c, hostd-convert)
+   v1.13: input queue is a heap on arrival time (heap.c), unsorted and
+          several dispatch files
+   v1.14: -b EASY backfilling of the user job queue, Admit/Backfill/
+          EstimateEnds fns, utilisation statistics
+   v1.15: -p N pool of pre-forked workers (worker.c)
+   v1.16: -ls posix_spawn launch, jobs tracked through pidfds (launch.c)
+   v1.17: -a N asynchronous suspend, Suspend/CollectStops/Now fns,
+          switch latency statistics
+   v1.18: fast-forward over idle ticks to the next arrival, IdleTicks fn
+   v1.19: processes tick on the dispatcher's clock (clock.c), the tick
+          is restarted before rather than after a dispatch, tick
+          lateness statistics
+   v1.20: -l levels, -q per-level time-slices, -B priority boost,
+          SetQuanta/Boost/Finished fns, turnaround percentiles
+   v1.21: -u srtf|hrrn user job policies on a heap, HigherRatio fn
+   v1.22: -u stride|lottery proportional share, NextUser/Draw/ShareOf/
+          ShareTick fns, cpu share statistics
+   v1.23: -u cfs on a red-black tree, -L latency, -g granularity,
+          FirstUser/WaitingUsers/Slice fns
+   v1.24: real-time deadlines, earliest deadline first with admission
+          control, AdmitRt/DeadlineCpu/AddSample fns, lateness statistics
+   v1.25: job timestamps, turnaround, waiting, response and admission
+          histograms by priority tier (latency.c), -H export,
+          ExportLatency fn replacing AddSample/CompareInt/Percentile
+   v1.26: --trace Chrome/Perfetto trace (trace.c), TraceJob/
+          TraceCounters/TraceTime fns
+   v1.27: --metrics textfile, -M interval, loop phase timings,
+          WriteMetrics/Phase fns
+   v1.28: --listen, jobs submitted at runtime through a unix socket
+          (submit.c, hostctl)
 *******************************************************************/
 
 #include "hostd.h"
 
-#define VERSION "1.4"
+#define VERSION "1.28"
 
 /******************************************************
  
@@ -95,7 +375,47 @@ history:
    
  ******************************************************/
 
-int CheckQueues(PcbPtr *);
+int CheckLoaders(void);
+int CheckCpus(void);
+int IdleCpus(void);
+int Waiting(CpuPtr, int);
+int PickCpu(void);
+void EnqCpu(CpuPtr, PcbPtr);
+PcbPtr Steal(CpuPtr);
+int PreemptCpu(void);
+int DeadlineCpu(void);
+int AdmitRt(PcbPtr, int);
+int CompareDeadline(const void *, const void *);
+int HigherRatio(PcbPtr, PcbPtr);
+PcbPtr FirstUser(void);
+PcbPtr NextUser(void);
+int WaitingUsers(void);
+int Slice(PcbPtr);
+int Draw(PcbPtr);
+int ShareOf(int);
+void ShareTick(int);
+void Suspend(CpuPtr, PcbPtr);
+void CollectStops(PcbPtr);
+void Dispatch(CpuPtr, PcbPtr);
+void Admit(PcbPtr, int);
+int Backfill(PcbQueuePtr, int);
+int CompareRemaining(const void *, const void *);
+int EstimateEnds(Estimate **);
+int EstimateEnd(Estimate *, int, int);
+void PrintStats(FILE *, int);
+void ReapChildren(int);
+int SetQuanta(char *);
+void Boost(void);
+void Finished(PcbPtr, int);
+void ExportLatency(char *);
+char * LatencyName(char *, int, char *, int);
+void TraceJob(PcbPtr, char *, int);
+void TraceCounters(int);
+long long TraceTime(void);
+void WriteMetrics(char *, int, int, int);
+void Phase(int);
+int IdleTicks(PcbHeapPtr, PcbQueuePtr, int);
+double Now(void);
 char * StripPath(char*);
 void PrintUsage(FILE *, char *);
 void SysErrMsg(char *, char *);
@@ -108,29 +428,104 @@ global variables
 
 ******************************************************/
 
-Mab  memory = { 0, MEMORY_SIZE, FALSE, NULL, NULL }; // memory arena
+Mab  memory = { 0, MEMORY_SIZE, FALSE, NULL, NULL, FALSE }; // memory arena
 Rsrc resources = { MAX_PRINTERS, MAX_SCANNERS, MAX_MODEMS, MAX_CDS };  // resource allocation table {2, 1, 1, 2}
+Cpu  cpus[MAX_CPUS];              // running slot, time-slice and feedback queues of each cpu
+int  ncpus = 1;                   // number of cpus in use
+PcbQueue rtqueue;                 // real-time queue (shared by all cpus)
+int  steals = 0;                  // processes taken from another cpu's queues
+int  migrations = 0;              // processes run on a different cpu than last time
+Loader loaders[MAX_INPUTS];       // one per dispatch file, each read a window at a time
+int  ninputs = 0;                 // number of dispatch files
+Submitter submitter;              // jobs submitted at runtime (--listen)
+char * listenpath = NULL;         //  its socket
+int  workers = 0;                 // parked workers to keep (-p)
+int  usermem = 0;                 // memory held by admitted user processes
+int  admitted = 0;                // user processes admitted
+int  backfilled = 0;              // of them, admitted past the head by Backfill
+long long admitwait = 0;          // ticks from arrival to admission, all of them
+long long busyticks = 0;          // cpu ticks spent running a process
+long long memticks = 0;           // user memory held, summed over ticks
+long long skipped = 0;            // idle ticks fast-forwarded
+int  freshtick = FALSE;           // restart the tick at the next Dispatch
+int  clockstats = FALSE;          // processes print their tick lateness (-s)
+int  lowpriority = LOW_PRIORITY;  // lowest user job feedback level (-l)
+int  quanta[MAX_QUEUES];          // time-slice of each level (-q)
+int  boost = 0;                   // ticks between priority boosts, 0 none (-B)
+int  boosts = 0;                  //  boosts done
+Tier tiers[N_TIERS];              // job latencies by priority tier (empty when zeroed)
+char * histfile = NULL;           //  file to export them to (-H)
+int  timenow = 0;                 // dispatcher timer, for pcb timestamps
+double tracetick = 0;             // --trace: microseconds in a tick (simulated)
+long long tracezero = 0;          //  and the monotonic clock at the start (live)
+char * metricsfile = NULL;        // file metrics are written to (--metrics)
+int  metricsticks = 1;            //  every this many ticks (-M)
+int  rejected = 0;                // jobs rejected as illegal or of unknown priority
+int  rtjobs = 0;                  // real-time jobs admitted
+long long dispatches = 0;         // jobs started or continued on a cpu
+long long suspends = 0;           //  and suspended (context switches)
+char * phases[] = { "input", "run", "dispatch", "wait" };
+long long phasens[N_PHASES];      // time spent in each phase of the loop (ns)
+int  phase = -1;                  //  the phase it is in
+long long phaseat = 0;            //  since
+int  rtadmitted = 0;              // real-time jobs with deadlines admitted
+int  rtrejected = 0;              //  rejected as their deadline couldn't be met
+int  rtpreempted = 0;             //  preempted by one with an earlier deadline
+int  rtmissed = 0;                //  ended after their deadline
+Latency lateness;                 //  ticks from deadline to end
+int  policy = POLICY_FB;          // how user jobs are chosen to run (-u)
+char * policies[] = { "fb", "srtf", "hrrn", "stride", "lottery", "cfs" };
+PcbBefore userbefore;             // -u: the order user jobs are run in
+PcbHeap userheap;                 // -u srtf|hrrn|stride|lottery: user jobs ready to run
+PcbTree usertree;                 // -u cfs: the same
+long long treeweight = 0;         //  tickets of the jobs on it
+int  latency = CFS_LATENCY;       //  target latency (-L)
+int  granularity = CFS_GRANULARITY;  //  minimum granularity (-g)
+int  ratiotime = 0;               //  the time response ratios are taken at
+int  preemptions = 0;             // -u srtf: user jobs preempted by shorter ones
+long long globalpass = 0;         // -u stride|cfs: pass of the last job taken
+Share shares[MAX_SHARES];         // -u stride|lottery: cpu share by tickets
+int  nshares = 0;                 //  ticket counts seen
+int  unshared = 0;                //  jobs with a ticket count past them
+long long activetickets = 0;      //  tickets of jobs admitted and not ended
+int  inflight = 1;                // most jobs running on a cpu at once (-a)
+PcbPtr stopping[MAX_CPUS * MAX_INFLIGHT];  // suspended, stop not yet seen
+int  nstopping = 0;               //  number of them
+int  switches = 0;                // dispatches onto a cpu just switched away from
+int  stopwaits = 0;               // -a: suspends that had to wait for a stop
+double switchus = 0, switchmax = 0;  // switch latency, total and worst (us)
 
 /******************************************************/
 
 int main (int argc, char *argv[])
 {
-    char * inputfile = NULL;      // job dispatch file's name
-    FILE * inputliststream;
-    PcbPtr inputqueue = NULL;     // input queue buffer
-    PcbPtr userjobqueue = NULL;   // arrived processes
-    PcbPtr dispatcherqueues[N_QUEUES];  // dispatcher queue array
-                  // [0] - real-time, [1]-[3] - feedback
-    PcbPtr currentprocess = NULL; // current process
+    char * inputfiles[MAX_INPUTS];  // job dispatch files' names
+    char * tracefile = NULL;      // trace of the dispatch timeline (--trace)
+    int lookahead = DEFAULT_LOOKAHEAD;  // size of the loaders' window in ticks
+    PcbHeap inputqueue;           // input queue buffer, earliest arrival first
+    PcbQueue userjobqueue;        // arrived processes
+    PcbPtr currentprocess = NULL; // process on the cpu being looked at
     PcbPtr process = NULL;        // working pcb pointer
-    MabPtr rtmemory = memAlloc(&memory, RT_MEMORY_SIZE); // fixed RT memory
+    MabPtr rtmemory = NULL;       // fixed RT memory, RT_MEMORY_SIZE a cpu
+    int rtreserve = TRUE;         //  allocated before the first job arrives
     int timer = 0;                // dispatcher timer
-    int quantum = QUANTUM;        // current time-slice quantum
+    double tickms = DEFAULT_TICK_MS;  // length of a tick
+    int events = EV_TICK;         // events since last pass through the loop
+    int ticks = 1;                // ticks the wait for the next one covers
+    int lastboost = 0;            // timer at the last priority boost (-B)
+    int lastmetrics = 0;          // timer the metrics were last written at
+    int skip = 1;                 //  and the length the tick timer is set to
+    int stats = FALSE;            // print statistics on exit
+    int backfill = FALSE;         // backfill the user job queue
+    int quantum = QUANTUM;        // time-slice of the cpu being looked at
     int i;                        // working index
-    int p;                        // current priority
+    int c;                        // current cpu
+    char msg[32];                 // working string
 
 //  0. Parse command line
 
+    for (i = 0; i < MAX_QUEUES; i++)
+        quanta[i] = QUANTUM;
     i = 0;
     while (++i < argc) {
         if (!strcmp(argv[i], "-mf")) {
@@ -146,45 +541,137 @@ int main (int argc, char *argv[])
             MabAlgorithm = WORST_FIT;
         } else
         if (!strcmp(argv[i], "-mnr")) {
-            memFree(rtmemory);            // don't preallocate RT memory
-            rtmemory = NULL;
+            rtreserve = FALSE;            // don't preallocate RT memory
         } else                
-        if (!inputfile) {
-            inputfile = argv[i];
+        if (!strcmp(argv[i], "-lf")) {
+            LaunchMode = LAUNCH_FORK;
+        } else
+        if (!strcmp(argv[i], "-ls")) {
+            LaunchMode = LAUNCH_SPAWN;
+        } else
+        if (!strcmp(argv[i], "--simulate")) {
+            SimMode = TRUE;
+        } else
+        if (!strcmp(argv[i], "--trace") && i + 1 < argc) {
+            tracefile = argv[++i];
+        } else
+        if (!strcmp(argv[i], "--metrics") && i + 1 < argc) {
+            metricsfile = argv[++i];
+        } else
+        if (!strcmp(argv[i], "--listen") && i + 1 < argc) {
+            listenpath = argv[++i];
+        } else
+        if (!strcmp(argv[i], "-M") && i + 1 < argc) {
+            if ((metricsticks = atoi(argv[++i])) < 1)
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (!strcmp(argv[i], "-s")) {
+            stats = TRUE;
+            clockstats = TRUE;
+        } else
+        if (!strcmp(argv[i], "-b")) {
+            backfill = TRUE;
+        } else
+        if (!strcmp(argv[i], "-a") && i + 1 < argc) {
+            inflight = atoi(argv[++i]);
+            if (inflight < 1 || inflight > MAX_INFLIGHT)
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+            if (workers < 0 || workers > MAX_WORKERS)
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+            ncpus = atoi(argv[++i]);
+            if (ncpus < 1 || ncpus > MAX_CPUS)
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (!strcmp(argv[i], "-u") && i + 1 < argc) {
+            for (policy = N_POLICIES - 1; policy >= 0; policy--)
+                if (!strcmp(argv[i + 1], policies[policy]))
+                    break;
+            if (policy < 0)
+                PrintUsage(stdout, argv[0]);
+            i++;
+        } else
+        if (!strcmp(argv[i], "-L") && i + 1 < argc) {
+            if ((latency = atoi(argv[++i])) < 1)
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+            if ((granularity = atoi(argv[++i])) < 1)
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+            lowpriority = HIGH_PRIORITY - 1 + atoi(argv[++i]);
+            if (lowpriority < HIGH_PRIORITY || lowpriority >= MAX_QUEUES)
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (!strcmp(argv[i], "-q") && i + 1 < argc) {
+            if (!SetQuanta(argv[++i]))
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (!strcmp(argv[i], "-B") && i + 1 < argc) {
+            if ((boost = atoi(argv[++i])) < 0)
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (!strcmp(argv[i], "-H") && i + 1 < argc) {
+            histfile = argv[++i];
+        } else
+        if (!strcmp(argv[i], "-w") && i + 1 < argc) {
+            if ((lookahead = atoi(argv[++i])) < 0)
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            if ((tickms = atof(argv[++i])) <= 0)
+                PrintUsage(stdout, argv[0]);
+        } else
+        if (ninputs < MAX_INPUTS) {
+            inputfiles[ninputs++] = argv[i];
         } else {
              PrintUsage(stdout, argv[0]);
         }
     }
-    if (!inputfile) PrintUsage(stdout, argv[0]);    
-    char * ans_file = InitAnsFile(inputfile);
+    if (!ninputs && !listenpath) PrintUsage(stdout, argv[0]);    
+    if (listenpath && SimMode) {
+        ErrMsg("--listen needs a real clock, not --simulate", NULL);
+        exit(2);
+    }
+    if (ncpus * RT_MEMORY_SIZE >= MEMORY_SIZE) {
+        ErrMsg("too many cpus to reserve real-time memory for", NULL);
+        exit(2);
+    }
+    char * ans_file = InitAnsFile(ninputs ? inputfiles[0] : listenpath);
 
-//  1. Initialize dispatcher queues (all others already initialised) ;
+//  1. Initialize dispatcher queues;
 
-    for (i = 0; i < N_QUEUES; dispatcherqueues[i++] = NULL);
+    initPcbHeap(&inputqueue, pcbArrivesBefore);
+    initPcbQueue(&userjobqueue);
+    initPcbQueue(&rtqueue);
+    userbefore = policy == POLICY_HRRN ? HigherRatio :
+                 PROPORTIONAL(policy) ? pcbPassBefore : pcbShorterRemaining;
+    initPcbHeap(&userheap, userbefore);
+    initPcbTree(&usertree, userbefore);
+    srandom(1);                   // the same draws every run (-u lottery)
+    for (c = 0; c < ncpus; c++)
+        initPcbLevels(&cpus[c].queues);
 
 //  2. Initialise memory and resource allocation structures
-//     (already done)
+//     (a real-time job's memory for every cpu, as one may run on each)
 
-//  3. Fill dispatcher queue from dispatch list file;
+    UserMemory = MEMORY_SIZE - ncpus * RT_MEMORY_SIZE;
+    if (rtreserve)
+        rtmemory = memAlloc(&memory, ncpus * RT_MEMORY_SIZE);
+
+//  3. Open dispatch list files; the input queue is filled from them
+//     a lookahead window at a time at the top of each pass of 5.
     
-    if (!(inputliststream = fopen(inputfile, "r"))) { // open it
-          SysErrMsg("could not open dispatch list file:", inputfile);
-          exit(2);
-    }
-
-    while (!feof(inputliststream)) {  // put processes into input_queue
-        process = createnullPcb();
-        if (fscanf(inputliststream,"%d, %d, %d, %d, %d, %d, %d, %d",
-             &(process->arrivaltime), &(process->priority),
-             &(process->remainingcputime), &(process->mbytes),
-             &(process->req.printers), &(process->req.scanners),
-             &(process->req.modems), &(process->req.cds)) != 8) {
-            free(process);
-            continue;  // Incomplete parameters, fail to create pcb
+    for (i = 0; i < ninputs; i++) {
+        if (!loadOpen(&loaders[i], inputfiles[i], ans_file, lookahead, i)) { // open it
+              SysErrMsg("could not open dispatch list file:", inputfiles[i]);
+              exit(2);
         }
-        process->status = PCB_INITIALIZED;  // create successfully
-        process->ans_file = ans_file;
-        inputqueue = enqPcb(inputqueue, process);  // enqueue->dipatch list
     }
 
 // ==================================================================================================================
@@ -192,66 +679,126 @@ int main (int argc, char *argv[])
 // ==================================================================================================================
 
 //  4. Start dispatcher timer;
-//     (already set to zero above)
+//     (already set to zero above, the tick timer starts here)
+
+    if (SimMode) {
+        if (!simOpen(ans_file)) exit(2);
+    } else
+    if (!evInit(tickms)) {
+        ErrMsg("could not start dispatcher event loop", NULL);
+        exit(2);
+    }
+    if (listenpath && !submitOpen(&submitter, listenpath, ans_file, MAX_INPUTS)) {
+        SysErrMsg("could not listen on", listenpath);
+        exit(2);
+    }
+    if (workers && !SimMode && !workOpen(DEFAULT_PROCESS, workers))
+        ErrMsg("could not start worker pool, forking each job", NULL);
+    if (tracefile) {
+        if (!traceOpen(tracefile)) exit(2);
+        tracetick = tickms * 1000;
+        tracezero = clockNow();
+        traceName(TRACE_CPUS, -1, "cpus");
+        for (c = 0; c < ncpus; c++) {
+            sprintf(msg, "cpu %d", c);
+            traceName(TRACE_CPUS, c, msg);
+        }
+        traceName(TRACE_QUEUES, -1, "queues");
+        traceName(TRACE_RESOURCES, -1, "resources");
+    }
         
 //  5. While there's anything in any of the queues or there's a currently running process:
-    while (inputqueue || userjobqueue || CheckQueues(dispatcherqueues) != -1 || currentprocess)
+    while (CheckLoaders() || inputqueue.length || userjobqueue.head || CheckCpus() ||
+           (listenpath && submitActive(&submitter)))
     {
+        timenow = timer;
+        Phase(PHASE_INPUT);
+
+        // a process that ended on its own gives back its cpu now
+        if (events & EV_CHILD) {
+            if (nstopping)
+                CollectStops(NULL);
+            ReapChildren(timer);
+        }
+
+        // top up the input queue with jobs due within the lookahead window
+        for (i = 0; i < ninputs; i++)
+            loadJobs(&loaders[i], &inputqueue, timer);
+        // and with jobs submitted since the last pass, arriving now
+        // (replies still to be taken are sent, or time out, too)
+        if ((events & (EV_INPUT | EV_OUTPUT)) || (listenpath && submitter.nclients))
+            submitJobs(&submitter, &inputqueue, timer);
+
 //      i. Unload any pending processes from the input queue:
-//         While (head-of-input-queue.arrival-time <= dispatcher timer)
-//         dequeue process from input queue and and enqueue on either
+//         While (earliest-of-input-queue.arrival-time <= dispatcher timer)
+//         pop process from input queue and and enqueue on either
 //           a. Real-time queue so check out parameters before enqueueing
+//              (its memory is the real-time reserve, RT_MEMORY_SIZE for
+//              each cpu, which the real-time jobs running hold a part of)
 //           b. user job queue - check out parameters before enqueueing
 //           c. unknown priority
 
     // assign processes in the input_queue to the realtime_queue or the userjob_queue
-        while (inputqueue && inputqueue->arrivaltime <= timer)
+        while ((process = topPcbHeap(&inputqueue)) && process->arrivaltime <= timer)
         {
-            if (inputqueue->priority == RT_PRIORITY)  // RT process, allocate memory
+            if (process->priority == RT_PRIORITY)  // RT process, allocate memory
             {
                 // check memory size and i/o resources
-                if (inputqueue->mbytes != RT_MEMORY_SIZE || inputqueue->req.cds || inputqueue->req.modems ||
-                inputqueue->req.printers || inputqueue->req.scanners)
+                if (process->mbytes != RT_MEMORY_SIZE || process->req.cds || process->req.modems ||
+                process->req.printers || process->req.scanners)
                 {
                     // dequeue and delete pcb
                     ErrMsg("Illegal Real Time Process", NULL);
-                    process = deqPcb(&inputqueue);
-                    free(process);
+                    rejected++;
+                    freePcb(popPcbHeap(&inputqueue));
+                    continue;
+                }
+                else if (!AdmitRt(process, timer))  // would miss a deadline
+                {
+                    ErrMsg("Real Time Process can't meet its deadline:",
+                        getPcbNickName(process));
+                    freePcb(popPcbHeap(&inputqueue));
+                    rtrejected++;
                     continue;
                 }
                 else if (rtmemory)  // have preallocated RT memory
-                    inputqueue->memoryblock = rtmemory;  // allocate memory (shared)
+                    process->memoryblock = rtmemory;  // allocate memory (the real-time reserve)
                 else  // have not preallocated RT memory
                 {
-                    if(!(rtmemory = memAlloc(&memory, RT_MEMORY_SIZE)))
+                    if(!(rtmemory = memAlloc(&memory, ncpus * RT_MEMORY_SIZE)))
                         break;  // memory can not be allocated
-                    inputqueue->memoryblock = rtmemory;  // allocate memory (shared)
+                    process->memoryblock = rtmemory;  // allocate memory (the real-time reserve)
                 }
-                process = deqPcb(&inputqueue);  // dequeue
-                dispatcherqueues[0] = enqPcb(dispatcherqueues[0], process);  // enqueue
+                popPcbHeap(&inputqueue);  // dequeue
+                if (process->deadline != INT_MAX)
+                    rtadmitted++;
+                process->tier = RT_PRIORITY;
+                rtjobs++;
+                process->admitted = timer;
+                insPcbQueue(&rtqueue, process, pcbDeadlineBefore);  // enqueue (shared by all cpus)
             }
-            else if (inputqueue->priority >= HIGH_PRIORITY && inputqueue->priority <= LOW_PRIORITY)  // user process
+            else if (process->priority >= HIGH_PRIORITY && process->priority <= LOW_PRIORITY)  // user process
             {
                 // check memory size and i/o resources
-                if (!memChkMax(inputqueue->mbytes) || !rsrcChkMax(inputqueue->req))
+                if (!memChkMax(process->mbytes) || !rsrcChkMax(process->req))
                 {
                     // illegal, dequeue and delete pcb
                     ErrMsg("Illegal User Process", NULL);
-                    process = deqPcb(&inputqueue);
-                    free(process);
+                    rejected++;
+                    freePcb(popPcbHeap(&inputqueue));
                 }
                 else
                 {
                     // legal
-                    process = deqPcb(&inputqueue);  // dequeue
-                    userjobqueue = enqPcb(userjobqueue, process);  // enqueue
+                    popPcbHeap(&inputqueue);  // dequeue
+                    enqPcbQueue(&userjobqueue, process);  // enqueue
                 }
             }
             else  // unknown priority
             {
                 ErrMsg("Unknown priority", NULL);
-                process = deqPcb(&inputqueue);
-                free(process);
+                rejected++;
+                freePcb(popPcbHeap(&inputqueue));
             }
         }
 
@@ -260,68 +807,83 @@ int main (int argc, char *argv[])
 //           a. dequeue process from user job queue
 //           b. allocate memory to the process
 //           c. allocate i/o resources to process
-//           d. enqueue on appropriate feedback queue
+//           d. enqueue on appropriate feedback queue of the least loaded cpu
+//         then (-b) backfill behind a head that can't be admitted
 
     // assign process in the userjob_queue to the queue with corresponding priority
-        while (userjobqueue)
+        while (userjobqueue.head)
         {
-            if (rsrcChk(&resources, userjobqueue->req))  // io resources can be allocated
+            if (rsrcChk(&resources, userjobqueue.head->req))  // io resources can be allocated
             {
-                if (!(userjobqueue->memoryblock = memAlloc(&memory, userjobqueue->mbytes)))
+                if (!(userjobqueue.head->memoryblock = memAlloc(&memory, userjobqueue.head->mbytes)))
                     break;  // memory can not be allocated
                 else
-                    rsrcAlloc(&resources, userjobqueue->req);  // allocate i/o resources
-                process = deqPcb(&userjobqueue);  // dequeue
-                p = process->priority;
-                dispatcherqueues[p] = enqPcb(dispatcherqueues[p], process);  // enqueue
+                    rsrcAlloc(&resources, userjobqueue.head->req);  // allocate i/o resources
+                process = deqPcbQueue(&userjobqueue);  // dequeue
+                Admit(process, timer);  // enqueue
             }
             else
                 break;  // io resources can not be allocated
         }
+        if (backfill && userjobqueue.head)
+            Backfill(&userjobqueue, timer);
 
-//    iii. If a process is currently running;
+//    iii. For each cpu, if a process is currently running;
 //          a. Decrement process remainingcputime;            
 //          b. If times up:                
 //             A. Send SIGINT to the process to terminate it;
 //             B. Free memory and resources we have allocated to the process;
 //             C. Free up process structure memory                
-//         c. else if a user process and other processes are waiting in feedback queues:                
+//         c. else if a user process and more processes are waiting for its cpu
+//            (real time or on its own feedback queues) than there are idle cpus:
 //             A. Send SIGTSTP to suspend it;
 //             B. Reduce the priority of the process (if possible) and enqueue it on
-//                the appropriate feedback queue;;
+//                the appropriate feedback queue of the same cpu;;
+//         then (-B) every S ticks move every user job to the highest level
 
-        if (currentprocess)
+        Phase(PHASE_RUN);
+        for (c = 0; c < ncpus && (events & EV_TICK); c++)
         {
+            if (!(currentprocess = cpus[c].process))
+                continue;
+            quantum = cpus[c].quantum;
             
 //          a. Decrement process remainingcputime;
 
             currentprocess->remainingcputime -= QUANTUM;
+            if (SimMode) simTick(currentprocess);
             
-//          b. If time is up:
+//          b. If time is up (or the process has ended on its own):
 
 //          for both RT processes and user processes
-            if (currentprocess->remainingcputime <= 0) 
+            if (currentprocess->remainingcputime <= 0 ||
+                currentprocess->status == PCB_TERMINATED) 
             {
 
 //             A. Send SIGINT to the process to terminate it;
 
+                TraceJob(currentprocess, currentprocess->status == PCB_TERMINATED ?
+                    "exit" : "SIGINT", FALSE);
                 terminatePcb(currentprocess);
                 
 //             B. Free up process structure memory
 
+                Finished(currentprocess, timer);
                 if (currentprocess->priority != RT_PRIORITY)  // free memoery and i/o resources only when user processes
                 {
                     memFree(currentprocess->memoryblock);  // free memory
+                    usermem -= currentprocess->mbytes;
                     rsrcFree(&resources, currentprocess->req);  // free i/o resources
                 }
-                free(currentprocess);  // free pcb
+                freePcb(currentprocess);  // free pcb
                 currentprocess = NULL;
             }
 
 //          c. If time is not up:
 
-//          only for user process
-            if (currentprocess && (currentprocess->priority != RT_PRIORITY))
+//          only for user process on the feedback queues
+            if (currentprocess && (currentprocess->priority != RT_PRIORITY) &&
+                policy == POLICY_FB)
             {
                 quantum -= QUANTUM;  // remaining time slice -1
 
@@ -329,89 +891,1488 @@ int main (int argc, char *argv[])
 
                 if (quantum <= 0)
                 {
-                    // get the priority of current waiting queue
-                    i = CheckQueues(dispatcherqueues);
-
-                    // no other processes are waiting
+                    // no other processes are waiting (or idle cpus will take them)
                     // restart time slice and hold priority
-                    if (i == -1)
-                        quantum = QUANTUM;  
+                    if (Waiting(&cpus[c], lowpriority + 1) <= IdleCpus())
+                        quantum = quanta[currentprocess->priority];
                     
                     // other processes are waiting
                     // suspend. degrade if necessary
                     else
                     {
                         // not the lowest priority, degrade
-                        if (currentprocess->priority != LOW_PRIORITY)
+                        if (currentprocess->priority < lowpriority)
                             currentprocess->priority++;
-                        p = currentprocess->priority;
-                        suspendPcb(currentprocess);  // suspend
-                        dispatcherqueues[p] = enqPcb(dispatcherqueues[p], currentprocess);
+                        Suspend(&cpus[c], currentprocess);  // suspend, resume here if possible
                         currentprocess = NULL;
                     }
                 }
 
 //              B. Time slice is not up and process of higher priority is waiting
 //              actually this situation does not exist because the time slice is 1
-                else if ((i = CheckQueues(dispatcherqueues)) > currentprocess->priority)
+                else if (Waiting(&cpus[c], currentprocess->priority) > IdleCpus())
                 {
                     // hold priority and suspend it
-                    suspendPcb(currentprocess);  // suspend current process
-                    p = currentprocess->priority;
-                    dispatcherqueues[p] = enqPcb(dispatcherqueues[p], currentprocess);
+                    Suspend(&cpus[c], currentprocess);  // suspend current process
                     currentprocess = NULL;
                 }
             }
+
+//          (-u stride|lottery|cfs) at the end of a time-slice, the waiting job
+//          with the lowest pass (least virtual runtime), or the one holding
+//          the ticket drawn, takes over
+
+            if (currentprocess && (currentprocess->priority != RT_PRIORITY) &&
+                PROPORTIONAL(policy))
+            {
+                currentprocess->pass += STRIDE1 / currentprocess->tickets;
+                if ((quantum -= QUANTUM) <= 0)
+                {
+                    quantum = policy == POLICY_CFS ? Slice(currentprocess) :
+                              quanta[currentprocess->priority];
+                    if (policy != POLICY_LOTTERY)
+                    {
+                        if ((process = FirstUser()) &&
+                            pcbPassBefore(process, currentprocess))
+                        {
+                            Suspend(&cpus[c], currentprocess);
+                            currentprocess = NULL;  // (step iv takes the first)
+                        }
+                    }
+                    else if ((i = Draw(currentprocess)) != -1)
+                    {
+                        process = rmPcbHeap(&userheap, i);
+                        Suspend(&cpus[c], currentprocess);
+                        Dispatch(&cpus[c], process);
+                        currentprocess = process;
+                        quantum = cpus[c].quantum;
+                    }
+                }
+            }
+            cpus[c].process = currentprocess;
+            cpus[c].quantum = quantum;
+        }
+        if (boost && policy == POLICY_FB && (events & EV_TICK) &&
+            timer - lastboost >= boost) {
+            Boost();
+            lastboost = timer;
         }
 
-//     iv. If no process currently running &&  queues are not empty:
-//         a. Dequeue process from  dispatcherqueues            
+//     iv. For each cpu with no process currently running:
+//         a. Dequeue process from the real time queue, else from the cpu's
+//            own highest priority feedback queue that is not empty, else
+//            steal one from the tail of the busiest other cpu's queues
 //         b. If already started but suspended, restart it (send SIGCONT to it)
 //              else start it (fork & exec)
 //         c. Set it as currently running process;
-
-        if (!currentprocess && (i = CheckQueues(dispatcherqueues)) != -1)
+//         then while real time processes are still waiting, preempt the
+//         lowest priority user process on any cpu to make room for them,
+//         then the real time process with the latest deadline if the
+//         first waiting has an earlier one;
+//         (-u srtf) then while the first user job on the heap has less
+//         left to run than one running, preempt the one with the most
+
+        Phase(PHASE_DISPATCH);
+
+        // dispatching part way through a tick onto otherwise idle cpus
+        // gives it a whole one (restarted by the first Dispatch)
+        freshtick = !SimMode && !(events & EV_TICK) && IdleCpus() == ncpus;
+        if (policy == POLICY_HRRN && userheap.length > 1 && IdleCpus()) {
+            ratiotime = timer;    // response ratios have grown since
+            reorderPcbHeap(&userheap);
+        }
+        for (c = 0; c < ncpus; c++)
+        {
+            if (cpus[c].process)
+                continue;
+            if (rtqueue.head)
+                Dispatch(&cpus[c], deqPcbQueue(&rtqueue));
+            else if (policy != POLICY_FB) {
+                if (WaitingUsers())
+                    Dispatch(&cpus[c], NextUser());
+            }
+            else if ((i = topPcbLevel(&cpus[c].queues)) != -1)
+                Dispatch(&cpus[c], deqPcbLevel(&cpus[c].queues, i));
+            else if ((process = Steal(&cpus[c])))
+                Dispatch(&cpus[c], process);
+        }
+        while (rtqueue.head && (c = PreemptCpu()) != -1)
+        {
+            // hold priority and suspend it
+            process = cpus[c].process;
+            cpus[c].process = NULL;
+            Suspend(&cpus[c], process);
+            Dispatch(&cpus[c], deqPcbQueue(&rtqueue));
+        }
+        while (rtqueue.head && (c = DeadlineCpu()) != -1 &&
+               pcbDeadlineBefore(rtqueue.head, cpus[c].process))
+        {
+            // earliest deadline first among real time processes too
+            process = cpus[c].process;
+            cpus[c].process = NULL;
+            Suspend(&cpus[c], process);
+            Dispatch(&cpus[c], deqPcbQueue(&rtqueue));
+            rtpreempted++;
+        }
+        while (policy == POLICY_SRTF && (process = topPcbHeap(&userheap)) &&
+               (c = PreemptCpu()) != -1 &&
+               pcbShorterRemaining(process, cpus[c].process))
         {
-            currentprocess = deqPcb(&dispatcherqueues[i]);
-            startPcb(currentprocess);
-            // if user process, set quantum
-            if (i != RT_PRIORITY)
-                quantum = QUANTUM;
+            // swap the job with the most left for the shorter one
+            process = cpus[c].process;
+            cpus[c].process = NULL;
+            Suspend(&cpus[c], process);
+            Dispatch(&cpus[c], popPcbHeap(&userheap));
+            preemptions++;
         }
+        for (c = 0; c < ncpus; c++)
+            cpus[c].switched = 0;  // a switch not followed by a dispatch
+        if (TraceMode)
+            TraceCounters(userjobqueue.length);
         
-//       v. sleep for quantum;
-
-        sleep(QUANTUM);
+//       v. wait for the next tick (or a child ending on its own); with
+//          nothing running or waiting, straight for the tick the next
+//          job arrives in (one deadline, at once when simulating)
+
+        Phase(PHASE_WAIT);
+        ticks = IdleTicks(&inputqueue, &userjobqueue, timer);
+        if (SimMode)
+            events = EV_TICK;  // virtual clock, nothing to wait for
+        else {
+            workRefill();      // replace workers used this pass
+            if (ticks != skip)
+                evSkip(ticks); // (back to) one tick
+            skip = ticks;
+            events = evWait();
+        }
             
 //      vi. Increment dispatcher timer;
 
-        timer += QUANTUM;
+        if (events & EV_TICK) {
+            timer += QUANTUM * ticks;
+            busyticks += (long long) (ncpus - IdleCpus()) * ticks;
+            memticks += (long long) usermem * ticks;
+            if (PROPORTIONAL(policy))
+                ShareTick(ticks);
+            skipped += ticks - 1;
+            skip = 1;
+        }
+        if (metricsfile && timer - lastmetrics >= metricsticks) {
+            Phase(-1);            // (writing them is not timed)
+            WriteMetrics(metricsfile, timer, inputqueue.length, userjobqueue.length);
+            lastmetrics = timer;
+        }
             
 //     vii. Go back to 5.
     }
         
 //    6. Exit
 
+    if (SimMode)
+        simClose();
+    else {
+        if (listenpath)
+            submitClose(&submitter);
+        workClose();
+        evClose();
+    }
+    traceClose();
+    Phase(-1);
+    if (metricsfile)
+        WriteMetrics(metricsfile, timer, 0, 0);
+    for (i = 0; i < ninputs; i++)
+        loadClose(&loaders[i]);
+    freePcbHeap(&inputqueue);
+    freePcbHeap(&userheap);
+    if (stats)
+        PrintStats(stdout, timer);
+    if (histfile)
+        ExportLatency(histfile);
+    poolDestroy(&PcbPool);        // release pcbs and memory blocks in bulk
+    poolDestroy(&MabPool);
     exit (0);
 }    
 
 
 /*******************************************************************
 
-int CheckQueues(PcbPtr * queues)
+int CheckLoaders(void)
+
+  returns TRUE if any dispatch file has jobs not yet read or handed out
+*******************************************************************/
+int CheckLoaders(void)
+{
+    int i;
 
-  check array of dispatcher queues
+    for (i = 0; i < ninputs; i++)
+        if (!loadDone(&loaders[i]))
+            return TRUE;
+    return FALSE;
+}
+
+/*******************************************************************
 
-  return priority of highest non-empty queue
-          -1 if all queues are empty
+int CheckCpus(void)
+
+  returns TRUE if any process is queued for, or running on, any cpu
 *******************************************************************/
-int CheckQueues(PcbPtr * queues)
+int CheckCpus(void)
 {
+    int c;
+
+    if (rtqueue.head || WaitingUsers()) return TRUE;
+    for (c = 0; c < ncpus; c++)
+        if (cpus[c].process || cpus[c].queues.nonempty)
+            return TRUE;
+    return FALSE;
+}
+
+/*******************************************************************
+
+int IdleCpus(void)
+
+  returns number of cpus with no process running
+*******************************************************************/
+int IdleCpus(void)
+{
+    int c, idle = 0;
+
+    for (c = 0; c < ncpus; c++)
+        if (!cpus[c].process) idle++;
+    return idle;
+}
+
+/*******************************************************************
+
+int Waiting(CpuPtr cpu, int priority)
+
+  count processes above priority that cpu would run next: everything
+  in the real time queue plus its own feedback queues [1] .. [priority - 1]
+
+  returns number of processes waiting
+*******************************************************************/
+int Waiting(CpuPtr cpu, int priority)
+{
+    return rtqueue.length + countPcbLevels(&cpu->queues, priority);
+}
+
+/*******************************************************************
+
+int PickCpu(void)
+
+  choose the cpu a newly admitted user process is queued on
+
+  returns the cpu with the fewest processes running and queued
+*******************************************************************/
+int PickCpu(void)
+{
+    int c, load, best = 0, bestload = -1;
+
+    for (c = 0; c < ncpus; c++) {
+        load = (cpus[c].process ? 1 : 0) + cpus[c].queues.length;
+        if (bestload == -1 || load < bestload) {
+            best = c;
+            bestload = load;
+        }
+    }
+    return best;
+}
+
+/*******************************************************************
+
+void EnqCpu(CpuPtr cpu, PcbPtr process)
+
+  enqueue a user process on cpu's feedback queue for its priority
+  (-u: on the user job heap or tree, whatever the cpu), or a real time
+  process back on the real time queue
+*******************************************************************/
+void EnqCpu(CpuPtr cpu, PcbPtr process)
+{
+    if (process->priority == RT_PRIORITY)
+        insPcbQueue(&rtqueue, process, pcbDeadlineBefore);
+    else if (policy == POLICY_FB)
+        enqPcbLevel(&cpu->queues, process, process->priority);
+    else if (policy == POLICY_CFS) {
+        insPcbTree(&usertree, process);
+        treeweight += process->tickets;
+    } else if (!pushPcbHeap(&userheap, process))
+        exit(2);
+}
+
+/*******************************************************************
+
+PcbPtr Steal(CpuPtr cpu)
+
+  take the process at the tail of the highest priority non-empty
+  queue of the busiest cpu other than cpu
+
+  returns the process taken
+          NULL if no other cpu has anything queued
+*******************************************************************/
+PcbPtr Steal(CpuPtr cpu)
+{
+    int c, busiest = -1, mostload = 0, p;
+    PcbLevelsPtr q;
+
+    for (c = 0; c < ncpus; c++) {
+        if (&cpus[c] == cpu) continue;
+        if (cpus[c].queues.length > mostload) {
+            busiest = c;
+            mostload = cpus[c].queues.length;
+        }
+    }
+    if (busiest == -1) return NULL;
+    q = &cpus[busiest].queues;
+    p = topPcbLevel(q);
+    steals++;
+    return rmPcbLevel(q, q->level[p].tail, p);
+}
+
+/*******************************************************************
+
+int PreemptCpu(void)
+
+  find the cpu a waiting real time process (or -u srtf, a shorter user
+  job) should take over
+
+  returns the cpu running the lowest priority user process (-u: the one
+            the user job heap or tree would put last)
+          -1 if every cpu is running a real time process
+*******************************************************************/
+int PreemptCpu(void)
+{
+    int c, victim = -1;
+
+    for (c = 0; c < ncpus; c++)
+        if (cpus[c].process && cpus[c].process->priority != RT_PRIORITY &&
+            (victim == -1 ||
+             (policy == POLICY_FB ?
+              cpus[c].process->priority > cpus[victim].process->priority :
+              userbefore(cpus[victim].process, cpus[c].process))))
+            victim = c;
+    return victim;
+}
+
+/*******************************************************************
+
+PcbPtr FirstUser(void)
+
+  returns the user job first on the user job heap or tree (-u), left
+            there
+          NULL if there is none
+*******************************************************************/
+PcbPtr FirstUser(void)
+{
+    if (policy == POLICY_CFS)
+        return firstPcbTree(&usertree);
+    return topPcbHeap(&userheap);
+}
+
+/*******************************************************************
+
+PcbPtr NextUser(void)
+
+  take the user job to run next off the user job heap or tree (-u),
+  which must not be empty; with stride or cfs its pass becomes the one
+  jobs admitted from now on start from, if that is later
+
+  returns the job taken
+*******************************************************************/
+PcbPtr NextUser(void)
+{
+    PcbPtr process;
+
+    if (policy == POLICY_LOTTERY)
+        return rmPcbHeap(&userheap, Draw(NULL));
+    if (policy == POLICY_CFS) {
+        process = rmPcbTree(&usertree, firstPcbTree(&usertree));
+        treeweight -= process->tickets;
+    } else
+        process = popPcbHeap(&userheap);
+    if (PROPORTIONAL(policy) && process->pass > globalpass)
+        globalpass = process->pass;
+    return process;
+}
+
+/*******************************************************************
+
+int WaitingUsers(void)
+
+  returns the number of user jobs on the user job heap or tree (-u)
+*******************************************************************/
+int WaitingUsers(void)
+{
+    return userheap.length + usertree.length;
+}
+
+/*******************************************************************
+
+int Slice(PcbPtr process)
+
+  cfs time-slice of a user job running (or about to) on a cpu: its
+  share by tickets of a period of the target latency, or of the
+  minimum granularity for every job runnable if that is longer, the
+  period being for all the cpus (-u cfs)
+
+  returns the time-slice in ticks, at least the minimum granularity
+*******************************************************************/
+int Slice(PcbPtr process)
+{
+    long long weight = treeweight, period, slice;
+    int c, n = usertree.length;
+
+    for (c = 0; c < ncpus; c++)
+        if (cpus[c].process && cpus[c].process->priority != RT_PRIORITY) {
+            weight += cpus[c].process->tickets;
+            n++;
+        }
+    period = (long long) n * granularity > latency ?
+             (long long) n * granularity : latency;
+    slice = weight ? period * ncpus * process->tickets / weight : period;
+    if (slice > period)
+        slice = period;           // a job runs on one cpu at a time
+    return slice > granularity ? slice : granularity;
+}
+
+/*******************************************************************
+
+int Draw(PcbPtr running)
+
+  draw a ticket among those of running (if not NULL) and of every job
+  on the user job heap (-u lottery)
+
+  returns the index on the heap of the job holding it
+          -1 if running holds it, or the heap is empty
+*******************************************************************/
+int Draw(PcbPtr running)
+{
+    long long total = running ? running->tickets : 0, ticket;
     int n;
 
-    for (n = 0; n < N_QUEUES; n++)
-        if (queues[n]) return n;
-    return -1;
+    if (!userheap.length)
+        return -1;
+    for (n = 0; n < userheap.length; n++)
+        total += userheap.item[n]->tickets;
+    ticket = random() % total;
+    if (running && (ticket -= running->tickets) < 0)
+        return -1;
+    for (n = 0; (ticket -= userheap.item[n]->tickets) >= 0; n++);
+    return n;
+}
+
+/*******************************************************************
+
+int ShareOf(int tickets)
+
+  find the share statistics of jobs holding tickets, starting them if
+  this is the first (-u stride|lottery)
+
+  returns index in shares
+          -1 if MAX_SHARES other ticket counts have been seen already
+*******************************************************************/
+int ShareOf(int tickets)
+{
+    int k;
+
+    for (k = 0; k < nshares; k++)
+        if (shares[k].tickets == tickets)
+            return k;
+    if (nshares == MAX_SHARES)
+        return -1;
+    memset(&shares[k], 0, sizeof(Share));
+    shares[k].tickets = tickets;
+    return nshares++;
+}
+
+/*******************************************************************
+
+void ShareTick(int ticks)
+
+  count ticks of the user jobs now running against what each ticket
+  count was due: the cpus running user jobs shared in proportion to
+  the tickets of every job admitted and not yet ended (not allowing
+  for a job running on one cpu at most, so the targets are only fair
+  while there are more jobs than cpus)
+*******************************************************************/
+void ShareTick(int ticks)
+{
+    PcbPtr p;
+    int c, k, busy = 0;
+
+    for (c = 0; c < ncpus; c++)
+        if ((p = cpus[c].process) && p->priority != RT_PRIORITY &&
+            (k = ShareOf(p->tickets)) != -1) {
+            shares[k].got += ticks;
+            busy += ticks;
+        }
+    if (!busy || !activetickets)
+        return;
+    for (k = 0; k < nshares; k++)
+        shares[k].target += (double) busy * shares[k].active / activetickets;
+}
+
+/*******************************************************************
+
+int DeadlineCpu(void)
+
+  find the cpu a waiting real time process with an earlier deadline
+  should take over, when every cpu runs a real time process
+
+  returns the cpu running the real time process with the latest
+            deadline
+          -1 if a cpu is idle or running a user process
+*******************************************************************/
+int DeadlineCpu(void)
+{
+    int c, victim = -1;
+
+    for (c = 0; c < ncpus; c++) {
+        if (!cpus[c].process || cpus[c].process->priority != RT_PRIORITY)
+            return -1;
+        if (victim == -1 || pcbDeadlineBefore(cpus[victim].process, cpus[c].process))
+            victim = c;
+    }
+    return victim;
+}
+
+/*******************************************************************
+
+int AdmitRt(PcbPtr process, int timer)
+
+  admission test of a real time process arriving at timer: the real
+  time processes with deadlines already running or queued and process
+  are run, in a model of global earliest deadline first, on all the
+  cpus from timer on (the ncpus earliest deadlines running, from one
+  job ending to the next, as none arrives), and process and those
+  with later deadlines, which it could hold up, must all end by their
+  deadlines. on one cpu this is the same as the time still needed by
+  each one from process on and those before it fitting in the time to
+  its deadline. on more, a set that would fit in all the cpus' time
+  can still miss (a long job left to run alone after short ones with
+  earlier deadlines), so that alone is not enough
+
+  returns TRUE if process has no deadline or every deadline would be
+            met, as the dispatcher runs them
+          FALSE if not
+*******************************************************************/
+int AdmitRt(PcbPtr process, int timer)
+{
+    static PcbPtr * rt = NULL;
+    static int * left = NULL;     //  cpu time each still needs, modelled
+    static int room = 0;
+    PcbPtr * more, p;
+    int * moreleft;
+    int n = 0, c, k, alive = 0, step, now = timer;
+
+    if (process->deadline == INT_MAX)
+        return TRUE;
+    if (process->remainingcputime > process->deadline - timer)
+        return FALSE;
+    if (rtqueue.length + ncpus + 1 > room) {
+        room = 2 * (rtqueue.length + ncpus + 1);
+        more = realloc(rt, room * sizeof(PcbPtr));
+        moreleft = realloc(left, room * sizeof(int));
+        if (more) rt = more;
+        if (moreleft) left = moreleft;
+        if (!more || !moreleft) {
+            SysErrMsg("testing real time admission", NULL);
+            exit(2);
+        }
+    }
+    for (c = 0; c < ncpus; c++)
+        if ((p = cpus[c].process) && p->priority == RT_PRIORITY &&
+            p->deadline != INT_MAX)
+            rt[n++] = p;
+    for (p = rtqueue.head; p && p->deadline != INT_MAX; p = p->next)
+        rt[n++] = p;
+    rt[n++] = process;
+    qsort(rt, n, sizeof(PcbPtr), CompareDeadline);
+    for (k = 0; k < n; k++)
+        if ((left[k] = rt[k]->remainingcputime) > 0)
+            alive++;
+    while (alive) {
+        // the ncpus earliest deadlines not ended run until one ends
+        step = INT_MAX;
+        for (k = 0, c = 0; k < n && c < ncpus; k++)
+            if (left[k] > 0) {
+                if (left[k] < step)
+                    step = left[k];
+                c++;
+            }
+        now += step;
+        for (k = 0, c = 0; k < n && c < ncpus; k++)
+            if (left[k] > 0) {
+                c++;
+                if ((left[k] -= step) > 0)
+                    continue;
+                alive--;
+                if (now > rt[k]->deadline && !pcbDeadlineBefore(rt[k], process))
+                    return FALSE;
+            }
+    }
+    return TRUE;
+}
+
+/*******************************************************************
+
+int CompareDeadline(const void * a, const void * b)
+
+  qsort order of PcbPtrs: earliest deadline first (pcbDeadlineBefore)
+*******************************************************************/
+int CompareDeadline(const void * a, const void * b)
+{
+    PcbPtr x = *(PcbPtr const *) a, y = *(PcbPtr const *) b;
+
+    return pcbDeadlineBefore(x, y) ? -1 : pcbDeadlineBefore(y, x);
+}
+
+/*******************************************************************
+
+int HigherRatio(PcbPtr a, PcbPtr b)
+
+  user job heap order for -u hrrn: response ratio at ratiotime,
+  (ratiotime - arrival + remaining) / remaining, compared without
+  dividing, then input order
+
+  returns TRUE if a has the higher ratio
+*******************************************************************/
+int HigherRatio(PcbPtr a, PcbPtr b)
+{
+    long long x = (long long) (ratiotime - a->arrivaltime + a->remainingcputime) *
+                  b->remainingcputime;
+    long long y = (long long) (ratiotime - b->arrivaltime + b->remainingcputime) *
+                  a->remainingcputime;
+
+    if (x != y)
+        return x > y;
+    return a->seq < b->seq;
+}
+
+/*******************************************************************
+
+void Dispatch(CpuPtr cpu, PcbPtr process)
+
+  start (or restart) a dequeued process on cpu, setting a fresh
+  time-slice for user processes, counting a migration if it last ran
+  on another cpu and adding the time it has been ready since arrival
+  or its suspend to its wait. live, the tick is restarted first if
+  freshtick is set and the process is handed the dispatcher's tick
+  grid
+*******************************************************************/
+void Dispatch(CpuPtr cpu, PcbPtr process)
+{
+    int c = cpu - cpus;
+    double us;
+
+    if (process->stopping)        // still stopping, see it through first
+        CollectStops(process);
+    if (!SimMode) {
+        if (freshtick) {
+            evRestartTick();
+            freshtick = FALSE;
+        }
+        // the process ticks on the dispatcher's grid (clock.c)
+        clockExport(evTickStart(), evTickLength(), clockstats);
+    }
+    cpu->process = process;
+    if (cpu->process->cpu != -1 && cpu->process->cpu != c)
+        migrations++;
+    cpu->process->cpu = c;
+    dispatches++;
+    TraceJob(process, process->started == -1 ? "START" : "SIGCONT", TRUE);
+    if (process->started == -1) {
+        process->started = timenow;
+        process->waited += timenow - process->arrivaltime;
+    } else
+        process->waited += timenow - process->readysince;
+    startPcb(cpu->process);
+    if (cpu->process->priority != RT_PRIORITY)
+        cpu->quantum = policy == POLICY_CFS ? Slice(cpu->process) :
+                       quanta[cpu->process->priority];
+    if (cpu->switched) {          // time from suspend to next start
+        us = (Now() - cpu->switched) * 1e6;
+        switchus += us;
+        if (us > switchmax)
+            switchmax = us;
+        switches++;
+        cpu->switched = 0;
+    }
+}
+
+/*******************************************************************
+
+void Suspend(CpuPtr cpu, PcbPtr process)
+
+  suspend process, which was running on cpu, and queue it there again.
+  with -a N the process is only sent SIGTSTP if fewer than N - 1 are
+  already on their way to stopping on cpu (see CollectStops), else it
+  is suspended and waited for
+*******************************************************************/
+void Suspend(CpuPtr cpu, PcbPtr process)
+{
+    process->readysince = timenow;
+    suspends++;
+    TraceJob(process, "SIGTSTP", FALSE);
+    if (!SimMode)
+        cpu->switched = Now();
+    if (inflight > 1 && !SimMode) {
+        if (cpu->stopping >= inflight - 1)
+            CollectStops(NULL);   // make room if any have stopped by now
+        if (cpu->stopping < inflight - 1) {
+            stopPcb(process);
+            stopping[nstopping++] = process;
+            cpu->stopping++;
+            EnqCpu(cpu, process);
+            return;
+        }
+        stopwaits++;
+    }
+    suspendPcb(process);
+    EnqCpu(cpu, process);
+}
+
+/*******************************************************************
+
+void CollectStops(PcbPtr process)
+
+  note which processes sent SIGTSTP by Suspend have stopped by now,
+  freeing their place on their cpu; process (if not NULL) is about
+  to be continued, so its stop is waited for
+*******************************************************************/
+void CollectStops(PcbPtr process)
+{
+    PcbPtr p;
+    int i = 0;
+
+    while (i < nstopping) {
+        p = stopping[i];
+        if (!stoppedPcb(p, FALSE)) {
+            if (p != process) {
+                i++;
+                continue;
+            }
+            stoppedPcb(p, TRUE);
+            stopwaits++;
+        }
+        cpus[p->cpu].stopping--;
+        stopping[i] = stopping[--nstopping];
+    }
+}
+
+/*******************************************************************
+
+void Admit(PcbPtr process, int timer)
+
+  queue a user process that has just been given its memory and i/o
+  resources on the least loaded cpu (at the lowest level if its
+  priority is below it, see -l), and count it in its tier. with
+  -u stride|lottery|cfs it starts from the pass of the last job taken
+  (stride: a tick later) and its tickets are counted among those
+  sharing the cpus
+*******************************************************************/
+void Admit(PcbPtr process, int timer)
+{
+    int k;
+
+    process->tier = process->priority;
+    process->admitted = timer;
+    if (process->priority > lowpriority)
+        process->priority = lowpriority;  // fewer levels than the file uses
+    usermem += process->mbytes;
+    admitted++;
+    admitwait += timer - process->arrivaltime;
+    if (PROPORTIONAL(policy)) {
+        process->pass = globalpass;
+        if (policy != POLICY_CFS)
+            process->pass += STRIDE1 / process->tickets;
+        if ((k = ShareOf(process->tickets)) != -1) {
+            shares[k].jobs++;
+            shares[k].active += process->tickets;
+            activetickets += process->tickets;
+        } else
+            unshared++;
+    }
+    EnqCpu(&cpus[PickCpu()], process);
+}
+
+/*******************************************************************
+
+int Backfill(PcbQueuePtr q, int timer)
+
+  EASY backfilling of user job queue q, whose head can't be admitted.
+  memory and i/o resources are given back, on paper, by processes in
+  order of estimated end until the head would fit: that is its shadow
+  time. a later job that fits now is admitted if it is expected to
+  end by the shadow time, or if the head would still fit then with
+  the job's memory block and i/o resources held
+
+  returns number of jobs admitted
+*******************************************************************/
+int Backfill(PcbQueuePtr q, int timer)
+{
+    Estimate * est;
+    PcbPtr head = q->head, process, next;
+    Rsrc avail = resources;       // i/o resources free at the shadow time
+    Rsrc spare;
+    MabPtr hold;
+    int n, k, end, shadow = INT_MAX, count = 0;
+
+    n = EstimateEnds(&est);
+    for (k = 0; k < n && shadow == INT_MAX; k++) {
+        if (est[k].process->priority == RT_PRIORITY)
+            continue;             // holds only the shared RT block
+        est[k].process->memoryblock->releasing = TRUE;
+        rsrcFree(&avail, est[k].process->req);
+        if (rsrcChk(&avail, head->req) && memFits(&memory, head->mbytes, NULL, 0))
+            shadow = timer + est[k].end;
+    }
+
+    for (process = head->next; process; process = next) {
+        next = process->next;
+        if (!rsrcChk(&resources, process->req) ||
+            !(hold = memPlace(&memory, process->mbytes)))
+            continue;             // doesn't fit now
+        end = timer + EstimateEnd(est, n, process->remainingcputime);
+        if (end > shadow) {       // still running when the head could start
+            spare = avail;
+            if (!rsrcAlloc(&spare, process->req) || !rsrcChk(&spare, head->req) ||
+                !memFits(&memory, head->mbytes, hold, process->mbytes))
+                continue;
+            avail = spare;
+        }
+        process->memoryblock = memAlloc(&memory, process->mbytes);
+        process->memoryblock->releasing = end <= shadow;
+        rsrcAlloc(&resources, process->req);
+        Admit(rmPcbQueue(q, process), timer);
+        backfilled++;
+        count++;
+    }
+
+    for (hold = &memory; hold; hold = hold->next)
+        hold->releasing = FALSE;
+    return count;
+}
+
+/*******************************************************************
+
+int CompareRemaining(const void * a, const void * b)
+
+  qsort order of estimates: least remaining cpu time first
+*******************************************************************/
+int CompareRemaining(const void * a, const void * b)
+{
+    const Estimate * x = a, * y = b;
+
+    if (x->remaining != y->remaining)
+        return x->remaining < y->remaining ? -1 : 1;
+    return x->process->seq < y->process->seq ? -1 : x->process->seq > y->process->seq;
+}
+
+/*******************************************************************
+
+int EstimateEnds(Estimate ** est)
+
+  estimate when each process running, or queued for a cpu, will end,
+  taking the cpus to be shared equally by all of them (processor
+  sharing, which round robin and feedback come close to). with n
+  processes sorted by remaining cpu time r[0] <= r[1] <= .. process k
+  ends after
+      max(r[k], (r[0] + .. + r[k-1] + (n - k) * r[k]) / ncpus)
+  ticks
+
+  est - set to the estimates (an array reused by the next call),
+        earliest end first
+
+  returns number of estimates
+*******************************************************************/
+int EstimateEnds(Estimate ** est)
+{
+    static Estimate * e = NULL;
+    static int room = 0;
+    Estimate * more;
+    PcbPtr p;
+    long long work = 0, end;
+    int n = rtqueue.length + WaitingUsers(), c, l, k;
+
+    for (c = 0; c < ncpus; c++)
+        n += (cpus[c].process ? 1 : 0) + cpus[c].queues.length;
+    if (n > room) {
+        if (!(more = realloc(e, 2 * n * sizeof(Estimate)))) {
+            SysErrMsg("estimating process ends", NULL);
+            exit(2);
+        }
+        e = more;
+        room = 2 * n;
+    }
+
+    n = 0;
+    for (c = 0; c < ncpus; c++) {
+        if (cpus[c].process)
+            e[n++].process = cpus[c].process;
+        for (l = HIGH_PRIORITY; l <= lowpriority; l++)
+            for (p = cpus[c].queues.level[l].head; p; p = p->next)
+                e[n++].process = p;
+    }
+    for (p = rtqueue.head; p; p = p->next)
+        e[n++].process = p;
+    for (k = 0; k < userheap.length; k++)
+        e[n++].process = userheap.item[k];
+    for (p = firstPcbTree(&usertree); p; p = nextPcbTree(p))
+        e[n++].process = p;
+    for (k = 0; k < n; k++)
+        e[k].remaining = e[k].process->remainingcputime;
+    qsort(e, n, sizeof(Estimate), CompareRemaining);
+    for (k = 0; k < n; k++) {
+        end = (work + (long long) (n - k) * e[k].remaining + ncpus - 1) / ncpus;
+        e[k].end = end > e[k].remaining ? end : e[k].remaining;
+        work += e[k].remaining;
+    }
+    *est = e;
+    return n;
+}
+
+/*******************************************************************
+
+int EstimateEnd(Estimate * est, int n, int remaining)
+
+  estimate when a job needing remaining cpu time would end if it
+  joined the n processes of est (see EstimateEnds)
+
+  returns ticks from now
+*******************************************************************/
+int EstimateEnd(Estimate * est, int n, int remaining)
+{
+    long long work = remaining, end;
+    int k;
+
+    for (k = 0; k < n && est[k].remaining < remaining; k++)
+        work += est[k].remaining;
+    work += (long long) (n - k) * remaining;
+    end = (work + ncpus - 1) / ncpus;
+    return end > remaining ? end : remaining;
+}
+
+/*******************************************************************
+
+void ReapChildren(int timer)
+
+  collect every child that has ended on its own (the process ran out
+  of ticks or crashed) without blocking. a running process among
+  them has its memory, i/o resources and pcb freed and its cpu
+  becomes idle (timer is the time now)
+*******************************************************************/
+void ReapChildren(int timer)
+{
+    pid_t pid;
+    int c, status;
+    PcbPtr running;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        if (workReaped(pid))
+            continue;             // a parked worker, not running anything
+        for (c = 0; c < ncpus; c++) {
+            if ((running = cpus[c].process) && running->pid == pid) {
+                running->status = PCB_TERMINATED;
+                TraceJob(running, "exit", FALSE);
+                Finished(running, timer);
+                if (running->priority != RT_PRIORITY) {
+                    memFree(running->memoryblock);
+                    usermem -= running->mbytes;
+                    rsrcFree(&resources, running->req);
+                }
+                freePcb(running);
+                cpus[c].process = NULL;
+            }
+        }
+    }
+}
+
+/*******************************************************************
+
+int SetQuanta(char * list)
+
+  set the time-slices of the feedback levels from a comma separated
+  list, highest level first, the last one holding for any levels
+  after it (-q)
+
+  returns TRUE if ok
+          FALSE if list has anything but whole numbers > 0
+*******************************************************************/
+int SetQuanta(char * list)
+{
+    int l = HIGH_PRIORITY, q = QUANTUM;
+    char * end;
+
+    while (l < MAX_QUEUES) {
+        if ((q = strtol(list, &end, 10)) < 1 || end == list)
+            return FALSE;
+        quanta[l++] = q;
+        if (*end == '\0')
+            break;
+        if (*end != ',')
+            return FALSE;
+        list = end + 1;
+    }
+    while (l < MAX_QUEUES)
+        quanta[l++] = q;
+    return TRUE;
+}
+
+/*******************************************************************
+
+void Boost(void)
+
+  move every queued user process to the highest feedback level of its
+  cpu (in level order) and give every running one the highest priority
+*******************************************************************/
+void Boost(void)
+{
+    PcbLevelsPtr q;
+    PcbPtr p;
+    int c, l;
+
+    for (c = 0; c < ncpus; c++) {
+        q = &cpus[c].queues;
+        for (l = HIGH_PRIORITY + 1; l <= lowpriority; l++)
+            while ((p = deqPcbLevel(q, l))) {
+                p->priority = HIGH_PRIORITY;
+                enqPcbLevel(q, p, HIGH_PRIORITY);
+            }
+        if ((p = cpus[c].process) && p->priority != RT_PRIORITY)
+            p->priority = HIGH_PRIORITY;
+    }
+    boosts++;
+}
+
+/*******************************************************************
+
+void Finished(PcbPtr process, int timer)
+
+  count the latencies of a process ending at timer in its tier and
+  among all jobs. a user process's tickets are taken out of those
+  sharing the cpus; a real time process with a deadline has its
+  lateness counted and a miss reported on stderr
+*******************************************************************/
+void Finished(PcbPtr process, int timer)
+{
+    char msg[NICKNAME_SIZE + 64];
+    int k, t;
+
+    for (t = process->tier; ; t = ALL_TIERS) {
+        latRecord(&tiers[t].turnaround, timer - process->arrivaltime);
+        latRecord(&tiers[t].waiting, process->waited);
+        latRecord(&tiers[t].response, process->started - process->arrivaltime);
+        latRecord(&tiers[t].admission, process->admitted - process->arrivaltime);
+        if (t == ALL_TIERS)
+            break;
+    }
+    if (process->priority == RT_PRIORITY) {
+        if (process->deadline == INT_MAX)
+            return;
+        latRecord(&lateness, timer - process->deadline);
+        if (timer > process->deadline) {
+            rtmissed++;
+            snprintf(msg, sizeof(msg), "%s missed its deadline by %d ticks",
+                process->args[1] ? process->args[1] : getPcbNickName(process),
+                timer - process->deadline);
+            ErrMsg("Real Time Process", msg);
+        }
+        return;
+    }
+    if (PROPORTIONAL(policy) && (k = ShareOf(process->tickets)) != -1) {
+        shares[k].active -= process->tickets;
+        activetickets -= process->tickets;
+    }
+}
+
+/*******************************************************************
+
+void ExportLatency(char * file)
+
+  write the percentile distribution of every latency histogram with
+  anything in it to file (see latExport), named by what it measures
+  and its tier
+*******************************************************************/
+void ExportLatency(char * file)
+{
+    char name[64];
+    FILE * stream;
+    int t;
+
+    if (!(stream = fopen(file, "w"))) {
+        SysErrMsg("could not write latency histograms to", file);
+        return;
+    }
+    for (t = 0; t < N_TIERS; t++) {
+        if (!tiers[t].turnaround.n)
+            continue;
+        LatencyName(name, sizeof(name), "turnaround", t);
+        latExport(&tiers[t].turnaround, name, stream);
+        LatencyName(name, sizeof(name), "waiting", t);
+        latExport(&tiers[t].waiting, name, stream);
+        LatencyName(name, sizeof(name), "response", t);
+        latExport(&tiers[t].response, name, stream);
+        LatencyName(name, sizeof(name), "admission", t);
+        latExport(&tiers[t].admission, name, stream);
+    }
+    if (lateness.n)
+        latExport(&lateness, "lateness real time", stream);
+    fclose(stream);
+}
+
+/*******************************************************************
+
+char * LatencyName(char * name, int size, char * metric, int tier)
+
+  returns name, set to metric followed by the tier it is for
+*******************************************************************/
+char * LatencyName(char * name, int size, char * metric, int tier)
+{
+    if (tier == ALL_TIERS)
+        snprintf(name, size, "%s all", metric);
+    else if (tier == RT_PRIORITY)
+        snprintf(name, size, "%s real time", metric);
+    else
+        snprintf(name, size, "%s priority %d", metric, tier);
+    return name;
+}
+
+/*******************************************************************
+
+void TraceJob(PcbPtr process, char * event, int running)
+
+  (--trace) an instant event on the track of the cpu process runs on,
+  after which it is running there (running TRUE) or not (FALSE); the
+  job keeps the name it started under
+*******************************************************************/
+void TraceJob(PcbPtr process, char * event, int running)
+{
+    long long us;
+    char * job;
+
+    if (!TraceMode)
+        return;
+    us = TraceTime();
+    // the name it started under (getPcbNickName would rename a job
+    // whose priority or time left has changed, answer file and all)
+    job = process->args[1] ? process->args[1] : getPcbNickName(process);
+    if (!running)
+        traceEnd(us, TRACE_CPUS, process->cpu);
+    traceInstant(us, TRACE_CPUS, process->cpu, event, job);
+    if (running)
+        traceBegin(us, TRACE_CPUS, process->cpu, job,
+            process->priority == RT_PRIORITY ? "real time" : "user");
+}
+
+/*******************************************************************
+
+void TraceCounters(int arrived)
+
+  (--trace) the length of every queue, arrived being the number of
+  jobs on the user job queue, and the memory and i/o resources free
+*******************************************************************/
+void TraceCounters(int arrived)
+{
+    static char levelname[MAX_QUEUES][16];
+    char * keys[MAX_QUEUES + 2];
+    long long values[MAX_QUEUES + 2];
+    int n = 0, l, c, largest, holes;
+    long long us = TraceTime();
+
+    keys[n] = "real time";
+    values[n++] = rtqueue.length;
+    keys[n] = "user job";
+    values[n++] = arrived;
+    if (policy == POLICY_FB)
+        for (l = HIGH_PRIORITY; l <= lowpriority; l++) {
+            if (!levelname[l][0])
+                sprintf(levelname[l], "level %d", l);
+            keys[n] = levelname[l];
+            values[n] = 0;
+            for (c = 0; c < ncpus; c++)
+                values[n] += cpus[c].queues.level[l].length;
+            n++;
+        }
+    else {
+        keys[n] = policy == POLICY_CFS ? "user tree" : "user heap";
+        values[n++] = WaitingUsers();
+    }
+    traceCounter(us, TRACE_QUEUES, "queues", n, keys, values);
+
+    keys[0] = "free";
+    values[0] = memAvail(&memory, &largest, &holes);
+    keys[1] = "largest free block";
+    values[1] = largest;
+    keys[2] = "free blocks";
+    values[2] = holes;
+    traceCounter(us, TRACE_RESOURCES, "memory", 3, keys, values);
+
+    keys[0] = "printers";
+    values[0] = resources.printers;
+    keys[1] = "scanners";
+    values[1] = resources.scanners;
+    keys[2] = "modems";
+    values[2] = resources.modems;
+    keys[3] = "cds";
+    values[3] = resources.cds;
+    traceCounter(us, TRACE_RESOURCES, "i/o resources", 4, keys, values);
+}
+
+/*******************************************************************
+
+long long TraceTime(void)
+
+  returns microseconds since the trace began: the dispatcher timer
+          times the tick length when simulating, else the monotonic
+          clock
+*******************************************************************/
+long long TraceTime(void)
+{
+    if (SimMode)
+        return (long long) (timenow * tracetick);
+    return (clockNow() - tracezero) / 1000;
+}
+
+/*******************************************************************
+
+void WriteMetrics(char * file, int timer, int inputs, int arrived)
+
+  write the dispatcher's metrics at timer to file in the Prometheus
+  text format, inputs and arrived being the jobs on the input and
+  user job queues. they are written to file.tmp and renamed to file,
+  so a reader never sees them half written
+*******************************************************************/
+void WriteMetrics(char * file, int timer, int inputs, int arrived)
+{
+    char tmp[PATH_MAX];
+    FILE * stream;
+    int l, c, depth, largest, holes, avail;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", file);
+    if (!(stream = fopen(tmp, "w"))) {
+        SysErrMsg("could not write metrics to", tmp);
+        metricsfile = NULL;       // don't try every tick
+        return;
+    }
+    fprintf(stream, "# TYPE hostd_timer_ticks gauge\n"
+        "hostd_timer_ticks %d\n", timer);
+
+    fprintf(stream, "# TYPE hostd_queue_depth gauge\n");
+    fprintf(stream, "hostd_queue_depth{queue=\"input\"} %d\n", inputs);
+    fprintf(stream, "hostd_queue_depth{queue=\"user job\"} %d\n", arrived);
+    fprintf(stream, "hostd_queue_depth{queue=\"real time\",priority=\"%d\"} %d\n",
+        RT_PRIORITY, rtqueue.length);
+    if (policy == POLICY_FB)
+        for (l = HIGH_PRIORITY; l <= lowpriority; l++) {
+            for (depth = 0, c = 0; c < ncpus; c++)
+                depth += cpus[c].queues.level[l].length;
+            fprintf(stream, "hostd_queue_depth{queue=\"feedback\",priority=\"%d\"} %d\n",
+                l, depth);
+        }
+    else
+        fprintf(stream, "hostd_queue_depth{queue=\"%s\"} %d\n", policies[policy],
+            WaitingUsers());
+    fprintf(stream, "# TYPE hostd_cpus_busy gauge\n"
+        "hostd_cpus_busy %d\n", ncpus - IdleCpus());
+
+    fprintf(stream, "# TYPE hostd_jobs_admitted_total counter\n");
+    fprintf(stream, "hostd_jobs_admitted_total{tier=\"real time\"} %d\n", rtjobs);
+    fprintf(stream, "hostd_jobs_admitted_total{tier=\"user\"} %d\n", admitted);
+    fprintf(stream, "# TYPE hostd_jobs_rejected_total counter\n");
+    fprintf(stream, "hostd_jobs_rejected_total{reason=\"illegal\"} %d\n", rejected);
+    fprintf(stream, "hostd_jobs_rejected_total{reason=\"deadline\"} %d\n", rtrejected);
+    if (listenpath) {
+        fprintf(stream, "hostd_jobs_rejected_total{reason=\"submission\"} %lld\n",
+            submitter.rejected);
+        fprintf(stream, "# TYPE hostd_jobs_submitted_total counter\n"
+            "hostd_jobs_submitted_total %lld\n", submitter.jobs);
+    }
+    fprintf(stream, "# TYPE hostd_jobs_completed_total counter\n");
+    for (l = 0; l < ALL_TIERS; l++)
+        fprintf(stream, "hostd_jobs_completed_total{priority=\"%d\"} %lld\n",
+            l, tiers[l].turnaround.n);
+
+    fprintf(stream, "# TYPE hostd_dispatches_total counter\n"
+        "hostd_dispatches_total %lld\n", dispatches);
+    fprintf(stream, "# TYPE hostd_context_switches_total counter\n"
+        "hostd_context_switches_total %lld\n", suspends);
+
+    avail = memAvail(&memory, &largest, &holes);
+    fprintf(stream, "# TYPE hostd_memory_free_mbytes gauge\n"
+        "hostd_memory_free_mbytes %d\n", avail);
+    fprintf(stream, "# TYPE hostd_memory_largest_free_mbytes gauge\n"
+        "hostd_memory_largest_free_mbytes %d\n", largest);
+    fprintf(stream, "# TYPE hostd_memory_free_blocks gauge\n"
+        "hostd_memory_free_blocks %d\n", holes);
+    fprintf(stream, "# TYPE hostd_memory_fragmentation gauge\n"
+        "hostd_memory_fragmentation %.4f\n",
+        avail ? 1.0 - (double) largest / avail : 0.0);
+
+    fprintf(stream, "# TYPE hostd_resources_available gauge\n");
+    fprintf(stream, "hostd_resources_available{resource=\"printers\"} %d\n",
+        resources.printers);
+    fprintf(stream, "hostd_resources_available{resource=\"scanners\"} %d\n",
+        resources.scanners);
+    fprintf(stream, "hostd_resources_available{resource=\"modems\"} %d\n",
+        resources.modems);
+    fprintf(stream, "hostd_resources_available{resource=\"cds\"} %d\n",
+        resources.cds);
+
+    fprintf(stream, "# TYPE hostd_phase_seconds_total counter\n");
+    for (l = 0; l < N_PHASES; l++)
+        fprintf(stream, "hostd_phase_seconds_total{phase=\"%s\"} %.6f\n",
+            phases[l], phasens[l] / 1e9);
+
+    if (fclose(stream) || rename(tmp, file)) {
+        SysErrMsg("could not write metrics to", file);
+        metricsfile = NULL;
+    }
+}
+
+/*******************************************************************
+
+void Phase(int next)
+
+  (--metrics) charge the time since the last call to the phase of the
+  loop it started, which is now next (-1 for none)
+*******************************************************************/
+void Phase(int next)
+{
+    long long now;
+
+    if (!metricsfile)
+        return;
+    now = clockNow();
+    if (phase != -1)
+        phasens[phase] += now - phaseat;
+    phase = next;
+    phaseat = now;
+}
+
+/*******************************************************************
+
+void PrintStats(FILE * stream, int timer)
+
+  print dispatcher statistics on stream, timer being the time taken
+*******************************************************************/
+void PrintStats(FILE * stream, int timer)
+{
+    int ticks = timer > 0 ? timer : 1;
+    long long total = 0;
+    double share, target, dev, devsum = 0, devmax = 0;
+    char name[64];
+    int l;
+
+    fprintf(stream, "cpus %d, steals %d, migrations %d\n",
+        ncpus, steals, migrations);
+    fprintf(stream, "makespan %d ticks, cpu utilisation %.1f%%, "
+        "user memory utilisation %.1f%%\n", timer,
+        100.0 * busyticks / ((long long) ncpus * ticks),
+        100.0 * memticks / ((long long) UserMemory * ticks));
+    fprintf(stream, "admitted %d user jobs (%d backfilled), "
+        "mean wait for admission %.2f ticks\n", admitted, backfilled,
+        admitted ? (double) admitwait / admitted : 0.0);
+    fprintf(stream, "idle ticks fast-forwarded %lld\n", skipped);
+    if (policy == POLICY_FB) {
+        fprintf(stream, "feedback levels %d, time-slices", lowpriority - HIGH_PRIORITY + 1);
+        for (l = HIGH_PRIORITY; l <= lowpriority; l++)
+            fprintf(stream, "%c%d", l == HIGH_PRIORITY ? ' ' : ',', quanta[l]);
+        fprintf(stream, ", boost every %d ticks (%d boosts)\n", boost, boosts);
+    } else if (policy == POLICY_SRTF)
+        fprintf(stream, "user job policy %s, %d preempted by shorter jobs\n",
+            policies[policy], preemptions);
+    else if (policy == POLICY_CFS)
+        fprintf(stream, "user job policy %s, target latency %d ticks, "
+            "minimum granularity %d ticks\n", policies[policy], latency,
+            granularity);
+    else
+        fprintf(stream, "user job policy %s\n", policies[policy]);
+    if (PROPORTIONAL(policy)) {
+        for (l = 0; l < nshares; l++)
+            total += shares[l].got;
+        for (l = 0; l < nshares; l++) {
+            share = total ? 100.0 * shares[l].got / total : 0.0;
+            target = total ? 100.0 * shares[l].target / total : 0.0;
+            dev = share > target ? share - target : target - share;
+            fprintf(stream, "tickets %d: %d jobs, cpu share %.2f%%, "
+                "target %.2f%%\n", shares[l].tickets, shares[l].jobs,
+                share, target);
+            devsum += dev * shares[l].got;
+            if (dev > devmax)
+                devmax = dev;
+        }
+        fprintf(stream, "cpu share deviation from target %.2f%% mean, "
+            "%.2f%% worst (%d jobs not counted)\n",
+            total ? devsum / total : 0.0, devmax, unshared);
+    }
+    for (l = 0; l < N_TIERS; l++) {
+        if (!tiers[l].turnaround.n)
+            continue;
+        latPrint(&tiers[l].turnaround,
+            LatencyName(name, sizeof(name), "turnaround", l), stream);
+        latPrint(&tiers[l].waiting,
+            LatencyName(name, sizeof(name), "waiting", l), stream);
+        latPrint(&tiers[l].response,
+            LatencyName(name, sizeof(name), "response", l), stream);
+        latPrint(&tiers[l].admission,
+            LatencyName(name, sizeof(name), "admission", l), stream);
+    }
+    if (rtadmitted || rtrejected)
+        fprintf(stream, "real time deadlines: %d admitted, %d rejected, "
+            "%d missed, %d preempted by an earlier deadline\n",
+            rtadmitted, rtrejected, rtmissed, rtpreempted);
+    if (lateness.n)
+        latPrint(&lateness, "lateness real time", stream);
+    if (!SimMode)
+        evPrint(stream);
+    if (!SimMode)
+        fprintf(stream, "switches %d, mean latency %.1f us, worst %.1f us "
+            "(-a %d, %d waited for a stop)\n", switches,
+            switches ? switchus / switches : 0.0, switchmax, inflight,
+            stopwaits);
+    if (workers)
+        workPrint(stream);
+    poolPrint(&PcbPool, stream);
+    poolPrint(&MabPool, stream);
+}
+
+/*******************************************************************
+
+int IdleTicks(PcbHeapPtr inputqueue, PcbQueuePtr userjobqueue, int timer)
+
+  returns the ticks from timer to the next arrival, on the input queue
+          or still in a dispatch file, if nothing is running on, queued
+          for or stopping on any cpu and no user job is waiting for
+          memory or i/o resources
+          1 otherwise (or if there is no next arrival, or a job could
+          be submitted at any time)
+*******************************************************************/
+int IdleTicks(PcbHeapPtr inputqueue, PcbQueuePtr userjobqueue, int timer)
+{
+    int next = INT_MAX, i, arrival;
+
+    if (userjobqueue->head || nstopping || CheckCpus() ||
+        (listenpath && submitActive(&submitter)))
+        return 1;
+    if (inputqueue->length)
+        next = topPcbHeap(inputqueue)->arrivaltime;
+    for (i = 0; i < ninputs; i++)
+        if ((arrival = loadNextArrival(&loaders[i])) < next)
+            next = arrival;
+    if (next == INT_MAX || next - timer <= QUANTUM)
+        return 1;
+    return (next - timer) / QUANTUM;
+}
+
+/*******************************************************************
+
+double Now(void)
+
+  returns the monotonic clock in seconds
+*******************************************************************/
+double Now(void)
+{
+    return clockNow() / 1e9;
 }
 
 /*******************************************************************
@@ -453,16 +2414,47 @@ void PrintUsage(FILE * stream, char * progname)
     
     fprintf(stream,"\n"
 "%s process dispatcher ( version " VERSION "); usage:\n\n"
-"  %s [-mf|-mn|-mb|-mw] <dispatch file>\n"
+"  %s [-mf|-mn|-mb|-mw] [-mnr] [-lf|-ls] [-a N] [-b] [-c N] [-p N]\n"
+"       [-u fb|srtf|hrrn|stride|lottery|cfs] [-L ticks] [-g ticks]\n"
+"       [-l N] [-q q1,q2,..] [-B S] [-t ms] [-w ticks] [-s] [-H file]\n"
+"       [--trace file] [--metrics file] [-M ticks] [--listen socket]\n"
+"       [--simulate] <dispatch file> [<dispatch file> ...]\n"
 " \n"
 "  where \n"
-"    <dispatch file> is list of process parameters \n"
+"    <dispatch file> is list of process parameters (text or binary)\n"
 "    -mx is optional selection of memory allocation algorithm \n"
 "      -mf First Fit (default) \n"
 "      -mn Next Fit \n"
 "      -mb Best Fit \n"
 "      -mw Worst Fit \n"
-"    -mnr don\'t preallocate real-time memory\n\n",
+"    -mnr don\'t preallocate real-time memory\n"
+"    -lx is optional selection of how jobs are started\n"
+"      -lf fork and exec (default)\n"
+"      -ls posix_spawn\n"
+"    -a N most jobs running on a cpu at once, suspends not waited for\n"
+"      (default 1)\n"
+"    -b backfill the user job queue\n"
+"    -c N number of cpus (default 1)\n"
+"    -p N keep N parked workers to start jobs on (default 0)\n"
+"    -u fb|srtf|hrrn|stride|lottery|cfs user jobs on feedback queues\n"
+"      (default), shortest remaining time first, highest response ratio\n"
+"      next, or shared by tickets (stride, lottery or completely fair\n"
+"      scheduling)\n"
+"    -L ticks cfs target latency (default 6)\n"
+"    -g ticks cfs minimum granularity (default 1)\n"
+"    -l N number of user job feedback levels (default 3)\n"
+"    -q q1,q2,.. time-slice of each feedback level in ticks (default 1)\n"
+"    -B S boost every user job to the highest level every S ticks\n"
+"    -t ms length of a dispatcher tick in milliseconds (default 1000)\n"
+"    -w ticks read dispatch file this far ahead of the timer (default 8)\n"
+"    -s print dispatcher statistics on exit\n"
+"    -H file write job latency histograms to file\n"
+"    --trace file write dispatch timeline trace (Chrome/Perfetto) to file\n"
+"    --metrics file write metrics to file (atomically) while running\n"
+"    -M ticks write the metrics every this many ticks (default 1)\n"
+"    --listen socket take jobs submitted to a unix socket (hostctl) too;\n"
+"      the dispatch files are then optional, answers go to <socket>.ans\n"
+"    --simulate run on a virtual clock without child processes\n\n",
     progname,progname);
     exit(127);
 }
@@ -499,10 +2491,13 @@ void SysErrMsg(char * msg1, char * msg2)
 
 char* InitAnsFile(char * inputfile)
 {
-    char* ans_file = malloc(sizeof(char) * 100);
-    strcpy(ans_file + strlen(ans_file), inputfile);
-    strcpy(ans_file + strlen(ans_file), ".ans");
-    fopen(ans_file, "w");
+    FILE * ans_stream;
+    char* ans_file = malloc(strlen(inputfile) + sizeof(".ans"));
+
+    strcpy(ans_file, inputfile);
+    strcat(ans_file, ".ans");
+    if ((ans_stream = fopen(ans_file, "w")))  // truncate
+        fclose(ans_stream);
 
     return ans_file;
 }             
@@ -21,6 +21,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <time.h>
 #include <signal.h>
 #include <sys/wait.h>
 #include <sys/types.h>
@@ -29,6 +31,16 @@
 #include "pcb.h"
 #include "mab.h"
 #include "rsrc.h"
+#include "event.h"
+#include "sim.h"
+#include "loader.h"
+#include "worker.h"
+#include "launch.h"
+#include "clock.h"
+#include "rbtree.h"
+#include "latency.h"
+#include "trace.h"
+#include "submit.h"
 
 #ifndef FALSE
 #define FALSE 0
@@ -40,4 +52,79 @@
 
 #define DEFAULT_NAME "hostd"
 #define QUANTUM  1
+#define MAX_CPUS 64
+#define MAX_INPUTS 16           /* dispatch files merged at once */
+#define MAX_INFLIGHT 8          /* jobs running on a cpu at once (-a) */
+
+/* how user jobs are chosen to run (-u) ***************************/
+
+#define POLICY_FB   0           /* per-cpu feedback queues (default) */
+#define POLICY_SRTF 1           /* shortest remaining time first, preemptive */
+#define POLICY_HRRN 2           /* highest response ratio next, runs to the end */
+#define POLICY_STRIDE  3        /* lowest pass first, passes growing by 1 / tickets */
+#define POLICY_LOTTERY 4        /* drawn by tickets every time-slice */
+#define POLICY_CFS  5           /* least virtual runtime first, slices scaled */
+#define N_POLICIES  6
+
+#define PROPORTIONAL(p) ((p) >= POLICY_STRIDE)  /* shared by tickets */
+#define STRIDE1     (1 << 20)   /* pass a one ticket job gains in a tick */
+#define CFS_LATENCY 6           /* ticks in which every job runs once (-L) */
+#define CFS_GRANULARITY 1       /* ticks, at least, a job runs for (-g) */
+#define MAX_SHARES  16          /* ticket counts whose cpu share is reported */
+
+/* a cpu runs at most one process at a time (-a: plus ones that have
+   been sent SIGTSTP but not yet stopped) **************************/
+
+struct cpu {
+    PcbPtr process;           // running process or NULL if idle
+    int quantum;              // time left in its time-slice
+    PcbLevels queues;         // feedback queues [1]-[3] ([0] unused,
+                              //  real-time processes share one queue)
+    int stopping;             // processes suspended here, stop not yet seen
+    double switched;          // when a switch away from process began, 0 if none
+};
+
+typedef struct cpu Cpu;
+typedef Cpu * CpuPtr;
+
+/* when a process holding or queued for a cpu should end (backfill) */
+struct estimate {
+    PcbPtr process;
+    int remaining;            // cpu time it still needs
+    int end;                  // ticks from now it is expected to end
+};
+
+typedef struct estimate Estimate;
+
+/* user jobs holding the same number of tickets (-u stride|lottery) */
+struct share {
+    int tickets;              // tickets each job holds
+    int jobs;                 // jobs admitted
+    long long active;         // tickets of those admitted and not ended
+    double target;            // cpu ticks due to them in proportion
+    long long got;            //  and cpu ticks they had
+};
+
+typedef struct share Share;
+
+/* latencies of the jobs of one priority tier (as given in the dispatch
+   file, RT_PRIORITY for real-time), or of all of them (ALL_TIERS) */
+#define ALL_TIERS   N_QUEUES
+#define N_TIERS     (N_QUEUES + 1)
+
+struct tier {
+    Latency turnaround;       // arrival to end
+    Latency waiting;          //  ready but not running, in all
+    Latency response;         //  arrival to first dispatch
+    Latency admission;        //  arrival to admission
+};
+
+typedef struct tier Tier;
+
+/* phases of the dispatcher loop, timed for --metrics */
+#define PHASE_INPUT    0        /* reap, read, steps i and ii */
+#define PHASE_RUN      1        /* step iii */
+#define PHASE_DISPATCH 2        /* step iv */
+#define PHASE_WAIT     3        /* step v */
+#define N_PHASES       4
 #endif
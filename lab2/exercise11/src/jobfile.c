@@ -0,0 +1,337 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  jobfile - binary dispatch file for HOST dispatcher
+
+   Replaying the same large trace again and again spends most of the
+   load time turning text back into the same integers. A binary
+   dispatch file holds each job as a fixed width record of int32
+   fields in the order of a dispatch file line, so once the file is
+   mmap'ed record n is simply records[n * fields].
+
+   layout (host byte order, the byteorder word catches a swapped file):
+
+      offset 0        JobHeader (64 bytes): magic, byte order, version,
+                      fields per record, index stride, record count
+                      and the offsets of the records and the index
+      records         count * fields int32, in arrival order
+      index           one JobIndex (arrival time) per stride records
+
+   A reader accepts any version up to JOB_VERSION. Newer versions may
+   only add fields to the end of a record; fields missing from an
+   older file read as 0. The index is small enough to stay in cache
+   and lets jobFind find the jobs due by a given time with a binary
+   search touching only a page or two of the records.
+
+   int jobIsBinary (char * file)
+    returns:
+      TRUE if file starts with JOB_MAGIC
+      FALSE otherwise (or if it can't be read)
+
+   int jobOpen (JobFilePtr j, char * file)
+      - map and check a binary dispatch file
+    returns:
+      TRUE if ok
+      FALSE if it could not be mapped or is not a valid job file
+            (reported on stderr)
+
+   void jobRecord (JobFilePtr j, size_t n, int * fields)
+      - copy the JOB_FIELDS fields of record n (< j->count) to fields
+    returns NONE
+
+   size_t jobFind (JobFilePtr j, int arrival, size_t from)
+      - find the first record at or after from arriving later than
+        arrival
+    returns:
+      its number, or j->count if there is none
+
+   void jobClose (JobFilePtr j)
+      - unmap the file
+    returns NONE
+
+   int jobCreate (JobWriterPtr w, char * file, int stride)
+      - create file and leave room for the header; an index entry
+        is kept every stride records (JOB_INDEX_STRIDE if <= 0)
+    returns:
+      TRUE if ok
+      FALSE if the file could not be created
+
+   int jobAppend (JobWriterPtr w, int * fields)
+      - write a record of JOB_FIELDS fields; records must come in
+        arrival order
+    returns:
+      TRUE if ok
+      FALSE if out of order or the write failed (reported on stderr)
+
+   int jobFinish (JobWriterPtr w)
+      - write the index, then the header, and close the file
+    returns:
+      TRUE if ok
+      FALSE if the file could not be written
+
+ ********************************************************************
+
+  version: 1.2
+  history:
+     v1.0: fixed width records with a sparse arrival time index
+     v1.1: format version 2, ninth field (tickets)
+     v1.2: format version 3, tenth field (deadline)
+
+ *******************************************************************/
+
+#include "jobfile.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*******************************************************
+ * static int jobError (char * file, char * msg)
+ *    - report a bad job file
+ *
+ * returns FALSE
+ *******************************************************/
+static int jobError(char * file, char * msg)
+{
+    fprintf(stderr, "ERROR - %s: %s\n", file, msg);
+    errno = EINVAL;                     // for the caller's perror
+    return FALSE;
+}
+
+/*******************************************************
+ * int jobIsBinary (char * file)
+ *
+ * returns:
+ *    TRUE if file starts with JOB_MAGIC
+ *******************************************************/
+int jobIsBinary(char * file)
+{
+    char magic[sizeof(JOB_MAGIC) - 1];
+    int fd, binary;
+
+    if ((fd = open(file, O_RDONLY)) == -1)
+        return FALSE;
+    binary = read(fd, magic, sizeof(magic)) == sizeof(magic) &&
+        !memcmp(magic, JOB_MAGIC, sizeof(magic));
+    close(fd);
+    return binary;
+}
+
+/*******************************************************
+ * int jobOpen (JobFilePtr j, char * file)
+ *    - map a binary dispatch file
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if it could not be mapped or is not valid
+ *******************************************************/
+int jobOpen(JobFilePtr j, char * file)
+{
+    const JobHeader * h;
+    struct stat st;
+    void * base;
+    int fd;
+
+    memset(j, 0, sizeof(*j));
+    j->file = file;
+
+    if ((fd = open(file, O_RDONLY)) == -1 || fstat(fd, &st) == -1) {
+        if (fd != -1) close(fd);
+        return FALSE;
+    }
+    if (st.st_size < (off_t) sizeof(JobHeader)) {
+        close(fd);
+        return jobError(file, "too short for a job file");
+    }
+    base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return FALSE;
+    j->base = base;
+    j->size = st.st_size;
+
+    h = (const JobHeader *) base;
+    if (memcmp(h->magic, JOB_MAGIC, sizeof(h->magic)))
+        return jobClose(j), jobError(file, "not a job file");
+    if (h->byteorder != JOB_BYTE_ORDER)
+        return jobClose(j), jobError(file, "written on a machine of other byte order");
+    if (h->version < 1 || h->version > JOB_VERSION)
+        return jobClose(j), jobError(file, "unsupported job file version");
+    if (h->fields < 1 || h->stride < 1 ||
+        h->records < sizeof(JobHeader) || h->records > j->size ||
+        h->records % sizeof(int32_t) ||
+        h->count > (j->size - h->records) / (h->fields * sizeof(int32_t)) ||
+        h->index % sizeof(JobIndex) || h->index > j->size ||
+        h->nindex != (h->count + h->stride - 1) / h->stride ||
+        h->nindex > (j->size - h->index) / sizeof(JobIndex))
+        return jobClose(j), jobError(file, "corrupt job file header");
+
+    j->records = (const int32_t *) (j->base + h->records);
+    j->fields = h->fields;
+    j->count = h->count;
+    j->index = (const JobIndex *) (j->base + h->index);
+    j->stride = h->stride;
+    j->nindex = h->nindex;
+    madvise((void *) j->base, j->size, MADV_SEQUENTIAL);
+    return TRUE;
+}
+
+/*******************************************************
+ * void jobRecord (JobFilePtr j, size_t n, int * fields)
+ *    - get the fields of record n
+ *
+ * returns NONE
+ *******************************************************/
+void jobRecord(JobFilePtr j, size_t n, int * fields)
+{
+    const int32_t * r = j->records + n * j->fields;
+    size_t i;
+
+    for (i = 0; i < JOB_FIELDS; i++)
+        fields[i] = i < j->fields ? r[i] : 0;
+}
+
+/*******************************************************
+ * size_t jobFind (JobFilePtr j, int arrival, size_t from)
+ *    - find the first record from on arriving after arrival
+ *
+ * returns:
+ *    its number, or j->count if there is none
+ *******************************************************/
+size_t jobFind(JobFilePtr j, int arrival, size_t from)
+{
+    size_t lo, hi, mid;
+
+    if (from >= j->count || j->records[from * j->fields] > arrival)
+        return from;                    // nothing due (the usual case)
+
+    // first index entry arriving later, the answer is in the stride before
+    lo = from / j->stride + 1;
+    hi = j->nindex;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (j->index[mid].arrival > arrival) hi = mid;
+        else lo = mid + 1;
+    }
+    hi = lo < j->nindex ? lo * j->stride : j->count;
+    lo = from + 1;
+    if (lo < (hi - 1) / j->stride * j->stride)
+        lo = (hi - 1) / j->stride * j->stride;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (j->records[mid * j->fields] > arrival) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+/*******************************************************
+ * void jobClose (JobFilePtr j)
+ *    - unmap the file
+ *
+ * returns NONE
+ *******************************************************/
+void jobClose(JobFilePtr j)
+{
+    if (j->base) munmap((void *) j->base, j->size);
+    j->base = NULL;
+    j->records = NULL;
+    j->index = NULL;
+    j->size = j->count = j->nindex = 0;
+}
+
+/*******************************************************
+ * int jobCreate (JobWriterPtr w, char * file, int stride)
+ *    - start writing a binary dispatch file
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if the file could not be created
+ *******************************************************/
+int jobCreate(JobWriterPtr w, char * file, int stride)
+{
+    memset(w, 0, sizeof(*w));
+    w->file = file;
+    memcpy(w->header.magic, JOB_MAGIC, sizeof(w->header.magic));
+    w->header.byteorder = JOB_BYTE_ORDER;
+    w->header.version = JOB_VERSION;
+    w->header.fields = JOB_FIELDS;
+    w->header.stride = stride > 0 ? stride : JOB_INDEX_STRIDE;
+    w->header.records = sizeof(JobHeader);
+
+    if (!(w->stream = fopen(file, "wb")))
+        return FALSE;
+    if (fwrite(&w->header, sizeof(JobHeader), 1, w->stream) != 1) {
+        fclose(w->stream);
+        w->stream = NULL;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*******************************************************
+ * int jobAppend (JobWriterPtr w, int * fields)
+ *    - write one record
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if out of order or the write failed
+ *******************************************************/
+int jobAppend(JobWriterPtr w, int * fields)
+{
+    int32_t r[JOB_FIELDS];
+    JobIndex * index;
+    int i;
+
+    if (w->header.count && fields[0] < w->last)
+        return jobError(w->file, "records must be in arrival order");
+    if (w->header.count % w->header.stride == 0) {
+        if (w->header.nindex == w->room) {
+            w->room = w->room ? w->room * 2 : 64;
+            if (!(index = realloc(w->index, w->room * sizeof(JobIndex))))
+                return jobError(w->file, "out of memory for the index");
+            w->index = index;
+        }
+        w->index[w->header.nindex].arrival = fields[0];
+        w->index[w->header.nindex++].pad = 0;
+    }
+    for (i = 0; i < JOB_FIELDS; i++)
+        r[i] = fields[i];
+    if (fwrite(r, sizeof(r), 1, w->stream) != 1)
+        return jobError(w->file, "write failed");
+    w->last = fields[0];
+    w->header.count++;
+    return TRUE;
+}
+
+/*******************************************************
+ * int jobFinish (JobWriterPtr w)
+ *    - write the index and header and close the file
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if the file could not be written
+ *******************************************************/
+int jobFinish(JobWriterPtr w)
+{
+    static const char zero[sizeof(JobIndex)];
+    uint64_t end = w->header.records +
+        w->header.count * w->header.fields * sizeof(int32_t);
+    int ok;
+
+    // index entries are aligned to their size
+    w->header.index = (end + sizeof(JobIndex) - 1) / sizeof(JobIndex) * sizeof(JobIndex);
+    ok = fwrite(zero, 1, w->header.index - end, w->stream) == w->header.index - end &&
+        fwrite(w->index, sizeof(JobIndex), w->header.nindex, w->stream) == w->header.nindex &&
+        fseek(w->stream, 0, SEEK_SET) == 0 &&
+        fwrite(&w->header, sizeof(JobHeader), 1, w->stream) == 1;
+    if (fclose(w->stream)) ok = FALSE;
+    w->stream = NULL;
+    free(w->index);
+    w->index = NULL;
+    return ok;
+}
@@ -0,0 +1,114 @@
+#ifndef JOBFILE_H
+#define JOBFILE_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  jobfile - binary dispatch file for HOST dispatcher
+
+  int jobIsBinary (char * file) - check a file for the binary magic
+  int jobOpen (JobFilePtr j, char * file) - map a binary dispatch file
+  void jobRecord (JobFilePtr j, size_t n, int * fields) - get record n
+  size_t jobFind (JobFilePtr j, int arrival, size_t from)
+      - find the first record arriving after arrival
+  void jobClose (JobFilePtr j) - unmap the file
+
+  int jobCreate (JobWriterPtr w, char * file, int stride) - start a file
+  int jobAppend (JobWriterPtr w, int * fields) - add one record
+  int jobFinish (JobWriterPtr w) - write the index and header
+
+  see jobfile.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.2
+  history:
+     v1.0: fixed width records with a sparse arrival time index
+     v1.1: format version 2, ninth field (tickets)
+     v1.2: format version 3, tenth field (deadline)
+
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+/* binary dispatch file definitions ****************************/
+
+#define JOB_MAGIC        "HOSTDJOB"     /* first 8 bytes of the file */
+#define JOB_BYTE_ORDER   0x01020304     /* reads differently if swapped */
+#define JOB_VERSION      3      /* 1: no tickets, 2: no deadline */
+#define JOB_FIELDS      10      /* arrival, priority, cpu, mbytes, prn, scn, modem, cd, */
+                                /*  tickets (0 for the default), deadline (0 none) */
+#define JOB_MIN_FIELDS   8      /* fields in a text line, at least */
+#define JOB_INDEX_STRIDE 512    /* records per index entry */
+
+struct jobheader {              // at offset 0, 64 bytes
+    char magic[8];             // JOB_MAGIC
+    uint32_t byteorder;        // JOB_BYTE_ORDER
+    uint32_t version;          // JOB_VERSION when written
+    uint32_t fields;           // int32 fields per record
+    uint32_t stride;           // records per index entry
+    uint64_t count;            // records
+    uint64_t records;          // offset of record 0
+    uint64_t index;            // offset of the index
+    uint64_t nindex;           // index entries
+    uint8_t reserved[8];
+};
+
+struct jobindex {               // one per stride records
+    int32_t arrival;           // arrival time of record (n * stride)
+    uint32_t pad;
+};
+
+typedef struct jobheader JobHeader;
+typedef struct jobindex JobIndex;
+
+struct jobfile {
+    char * file;               // for error messages
+    const char * base;         // the mapped file
+    size_t size;               // its length
+    const int32_t * records;   // record 0
+    size_t fields;             // fields per record
+    size_t count;              // records
+    const JobIndex * index;    // arrival of every stride'th record
+    size_t stride;
+    size_t nindex;
+};
+
+typedef struct jobfile JobFile;
+typedef JobFile * JobFilePtr;
+
+struct jobwriter {
+    char * file;
+    FILE * stream;
+    JobHeader header;
+    JobIndex * index;          // built up as records are appended
+    size_t room;               // index entries allocated
+    int last;                  // arrival of the previous record
+};
+
+typedef struct jobwriter JobWriter;
+typedef JobWriter * JobWriterPtr;
+
+/* binary dispatch file prototypes *****************************/
+
+int    jobIsBinary(char *);
+int    jobOpen(JobFilePtr, char *);
+void   jobRecord(JobFilePtr, size_t, int *);
+size_t jobFind(JobFilePtr, int, size_t);
+void   jobClose(JobFilePtr);
+
+int    jobCreate(JobWriterPtr, char *, int);
+int    jobAppend(JobWriterPtr, int *);
+int    jobFinish(JobWriterPtr);
+
+#endif
@@ -0,0 +1,230 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  latency - histograms of job latencies for HOST dispatcher
+
+   A job's latencies are counted in a log-linear histogram in the
+   manner of HdrHistogram rather than kept one by one: values below
+   LAT_SUB_COUNT each have a count of their own and above that every
+   doubling of the range is split into LAT_HALF equal counts, so any
+   value is known to within 1 part in LAT_HALF, recording one is a
+   couple of shifts and the histogram stays the same size however
+   many jobs are run. Negative values (a job finishing before its
+   deadline) are counted apart by their magnitude.
+
+   void latInit (LatencyPtr h)
+      - make h empty
+    returns NONE
+
+   void latRecord (LatencyPtr h, int value)
+      - count value in h
+    returns NONE
+
+   double latMean (LatencyPtr h)
+    returns the exact mean of the values counted (0 if none)
+
+   int latPercentile (LatencyPtr h, double p)
+    returns the least value (to the histogram's precision) that p
+      percent of those counted are no greater than, never more than
+      the greatest counted (0 if none)
+
+   void latPrint (LatencyPtr h, char * name, FILE * iostream)
+      - print count, mean, p50, p95, p99 and max of h on one line
+    returns NONE
+
+   void latExport (LatencyPtr h, char * name, FILE * iostream)
+      - write h as a "#[name]" line and a percentile distribution in
+        HdrHistogram's text format (Value, Percentile, TotalCount,
+        1/(1-Percentile) at 5 steps per halving of the distance to
+        100%), which its plotting tools read
+    returns NONE
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: log-linear (HDR) histograms, percentile distribution export
+
+ *******************************************************************/
+
+#include "latency.h"
+#include <limits.h>
+#include <string.h>
+#include <math.h>
+
+#define LAT_TICKS 5                     /* export steps per halving */
+
+/*******************************************************
+ * static int Index (int v)  - count of v (v >= 0)
+ * static int Lowest (int i) - least value counted in i
+ * static int Width (int i)  - values counted in i
+ *******************************************************/
+static int Index(int v)
+{
+    int b = 0;
+
+    while ((v >> b) >= LAT_SUB_COUNT)
+        b++;
+    return b * LAT_HALF + (v >> b);
+}
+
+static int Width(int i)
+{
+    return i < LAT_SUB_COUNT ? 1 : 1 << (i / LAT_HALF - 1);
+}
+
+static int Lowest(int i)
+{
+    int b = i < LAT_SUB_COUNT ? 0 : i / LAT_HALF - 1;
+
+    return (i - b * LAT_HALF) << b;
+}
+
+/*******************************************************
+ * static int Value (LatencyPtr h, int k)
+ *    - value of the k-th count in increasing order of value
+ *      (most negative first), and
+ * static long long Count (LatencyPtr h, int k) - that count
+ *
+ * k runs from 0 to 2 * LAT_COUNTS - 1; the greatest value a
+ * count stands for is used, clamped to the histogram's max
+ *******************************************************/
+static int Value(LatencyPtr h, int k)
+{
+    long long v;
+
+    if (k < LAT_COUNTS)                 // negatives, largest magnitude first
+        v = -(long long)Lowest(LAT_COUNTS - 1 - k);
+    else
+        v = (long long)Lowest(k - LAT_COUNTS) + Width(k - LAT_COUNTS) - 1;
+    return v > h->max ? h->max : v < h->min ? h->min : (int)v;
+}
+
+static long long Count(LatencyPtr h, int k)
+{
+    if (k < LAT_COUNTS)
+        return h->count[1][LAT_COUNTS - 1 - k];
+    return h->count[0][k - LAT_COUNTS];
+}
+
+/*******************************************************
+ * void latInit (LatencyPtr h)
+ *    - empty a histogram
+ *
+ * returns NONE
+ *******************************************************/
+void latInit(LatencyPtr h)
+{
+    memset(h, 0, sizeof(Latency));
+}
+
+/*******************************************************
+ * void latRecord (LatencyPtr h, int value)
+ *    - count a value
+ *
+ * returns NONE
+ *******************************************************/
+void latRecord(LatencyPtr h, int value)
+{
+    if (value >= 0)
+        h->count[0][Index(value)]++;
+    else
+        h->count[1][Index(value == INT_MIN ? INT_MAX : -value)]++;
+    if (!h->n || value < h->min)
+        h->min = value;
+    if (!h->n || value > h->max)
+        h->max = value;
+    h->n++;
+    h->sum += value;
+    h->squares += (double)value * value;
+}
+
+/*******************************************************
+ * double latMean (LatencyPtr h)
+ *
+ * returns mean of the values counted
+ *******************************************************/
+double latMean(LatencyPtr h)
+{
+    return h->n ? (double)h->sum / h->n : 0.0;
+}
+
+/*******************************************************
+ * int latPercentile (LatencyPtr h, double p)
+ *    - p-th percentile of the values counted
+ *
+ * returns percentile (0 if nothing counted)
+ *******************************************************/
+int latPercentile(LatencyPtr h, double p)
+{
+    long long want, seen = 0;
+    int k;
+
+    if (!h->n)
+        return 0;
+    want = (long long)ceil(p / 100.0 * h->n);
+    if (want < 1)
+        want = 1;
+    for (k = 0; k < 2 * LAT_COUNTS; k++)
+        if ((seen += Count(h, k)) >= want)
+            return Value(h, k);
+    return h->max;
+}
+
+/*******************************************************
+ * void latPrint (LatencyPtr h, char * name, FILE * iostream)
+ *    - print a histogram's summary
+ *
+ * returns NONE
+ *******************************************************/
+void latPrint(LatencyPtr h, char * name, FILE * stream)
+{
+    fprintf(stream, "%s: %lld jobs, mean %.2f, p50 %d, p95 %d, p99 %d, "
+        "max %d ticks\n", name, h->n, latMean(h), latPercentile(h, 50),
+        latPercentile(h, 95), latPercentile(h, 99), h->max);
+}
+
+/*******************************************************
+ * void latExport (LatencyPtr h, char * name, FILE * iostream)
+ *    - write a histogram's percentile distribution
+ *
+ * returns NONE
+ *******************************************************/
+void latExport(LatencyPtr h, char * name, FILE * stream)
+{
+    double level = 0.0, mean = latMean(h), sd;
+    long long seen = 0, count;
+    int k, buckets;
+
+    fprintf(stream, "#[%s]\n%12s %14s %10s %14s\n\n", name,
+        "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+    for (k = 0; h->n && k < 2 * LAT_COUNTS; k++) {
+        if (!(count = Count(h, k)))
+            continue;
+        seen += count;
+        // every level this count reaches, but only the first once
+        // everything has been seen, and then 100% to finish
+        while (100.0 * seen / h->n >= level) {
+            fprintf(stream, "%12.3f %14.12f %10lld %14.2f\n",
+                (double)Value(h, k), level / 100.0, seen,
+                1.0 / (1.0 - level / 100.0));
+            level += 100.0 / (LAT_TICKS *
+                pow(2.0, floor(log2(100.0 / (100.0 - level))) + 1));
+            if (seen == h->n)
+                break;
+        }
+        if (seen == h->n) {
+            fprintf(stream, "%12.3f %14.12f %10lld\n",
+                (double)Value(h, k), 1.0, seen);
+            break;
+        }
+    }
+    sd = h->n ? sqrt(fabs(h->squares / h->n - mean * mean)) : 0.0;
+    buckets = Index(h->max > 0 ? h->max : 0) / LAT_HALF + 1;
+    fprintf(stream, "#[Mean    = %12.3f, StdDeviation   = %12.3f]\n", mean, sd);
+    fprintf(stream, "#[Max     = %12.3f, Total count    = %12lld]\n",
+        (double)h->max, h->n);
+    fprintf(stream, "#[Buckets = %12d, SubBuckets     = %12d]\n",
+        buckets, LAT_SUB_COUNT);
+}
@@ -0,0 +1,65 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  latency - histograms of job latencies for HOST dispatcher
+
+  void latInit (LatencyPtr h) - make h empty
+  void latRecord (LatencyPtr h, int value) - count a value
+  double latMean (LatencyPtr h) - mean of the values counted
+  int latPercentile (LatencyPtr h, double p) - p-th percentile
+  void latPrint (LatencyPtr h, char * name, FILE * iostream)
+      - print count, mean, p50, p95, p99 and max
+  void latExport (LatencyPtr h, char * name, FILE * iostream)
+      - write the percentile distribution (HdrHistogram format)
+
+  see latency.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: log-linear (HDR) histograms, percentile distribution export
+
+ *******************************************************************/
+
+#include <stdio.h>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+/* latency definitions *****************************************/
+
+#define LAT_SUB_BITS  7                        /* 128 sub-buckets, */
+#define LAT_SUB_COUNT (1 << LAT_SUB_BITS)      /*  values within 1 in 64 */
+#define LAT_HALF      (LAT_SUB_COUNT / 2)
+#define LAT_COUNTS    ((33 - LAT_SUB_BITS) * LAT_HALF)  /* to INT_MAX */
+
+struct latency {
+    long long count[2][LAT_COUNTS];  // [0] values >= 0, [1] -values < 0
+    long long n;               // values counted
+    long long sum;             //  their total
+    double squares;            //  and sum of squares
+    int min, max;
+};
+
+typedef struct latency Latency;
+typedef Latency * LatencyPtr;
+
+/* latency prototypes ******************************************/
+
+void   latInit(LatencyPtr);
+void   latRecord(LatencyPtr, int);
+double latMean(LatencyPtr);
+int    latPercentile(LatencyPtr, double);
+void   latPrint(LatencyPtr, char *, FILE *);
+void   latExport(LatencyPtr, char *, FILE *);
+
+#endif
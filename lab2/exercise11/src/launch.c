@@ -0,0 +1,209 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  launch - process launch and control for HOST dispatcher
+
+   fork() copies the page tables of the whole dispatcher, which grows
+   with the number of jobs it holds, only for the child to exec. With
+   LAUNCH_SPAWN a process is started with posix_spawnp instead (glibc
+   runs it as clone(CLONE_VM | CLONE_VFORK), nothing is copied). The
+   child's signal mask is set by a spawn attribute and a file action
+   opens the answer file on LAUNCH_ANS_FD, so 'process' is given
+   LAUNCH_ANS_ARG in place of the file name and appends to the open
+   descriptor rather than opening the file for every line.
+
+   Every child, however it was started, is tracked through a pidfd.
+   Signals go through pidfd_send_signal and a terminated child is
+   waited for by polling its pidfd (readable once it has exited) and
+   then reaped with waitid(P_PIDFD), so a pid that has been reused
+   can never be signalled or reaped by mistake. Without pidfds (a
+   kernel before 5.3) kill and waitpid are used as before.
+
+   pid_t launchSpawn (char ** args, char * ans_file)
+      - spawn args[0] with args, SIGCHLD unblocked and ans_file (if
+        not NULL) open for appending on LAUNCH_ANS_FD
+    returns:
+      pid of the child
+      -1 if it could not be spawned (errno set)
+
+   int launchPidfd (pid_t pid)
+    returns:
+      a pidfd (close on exec) for child pid
+      -1 if pidfds aren't available
+
+   int launchSignal (pid_t pid, int pidfd, int sig)
+      - send sig to child pid, through pidfd unless it is -1
+    returns:
+      0 if ok
+      -1 on error (errno set)
+
+   int launchWait (pid_t pid, int pidfd, int stopped)
+      - wait for child pid to stop or end (stopped TRUE) or just to
+        end (FALSE), through pidfd unless it is -1. a child that has
+        ended is reaped
+    returns:
+      0 if ok
+      -1 on error (errno set)
+
+   int launchPoll (pid_t pid, int pidfd)
+      - collect a stop or end of child pid if there is one, without
+        waiting (a child that has ended is reaped)
+    returns:
+      TRUE if it has stopped or ended (or is already gone)
+      FALSE if it is still running
+
+   extern int LaunchMode; - LAUNCH_FORK (default) or LAUNCH_SPAWN
+
+ ********************************************************************
+
+  version: 1.1
+  history:
+     v1.0: posix_spawn backend, children tracked through pidfds
+     v1.1: launchPoll, collect a stop without waiting for it
+
+ *******************************************************************/
+
+#define _GNU_SOURCE
+#include "launch.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#define LAUNCH_P_PIDFD 3          /* waitid idtype (P_PIDFD, Linux 5.4) */
+
+extern char ** environ;
+
+int LaunchMode = LAUNCH_FORK;
+
+/*******************************************************
+ * pid_t launchSpawn (char ** args, char * ans_file)
+ *    - posix_spawn a process
+ *
+ * returns:
+ *    pid of the child
+ *    -1 if it could not be spawned
+ *******************************************************/
+pid_t launchSpawn(char ** args, char * ans_file)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t mask;
+    pid_t pid;
+    int rc;
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
+    if (ans_file)
+        posix_spawn_file_actions_addopen(&actions, LAUNCH_ANS_FD, ans_file,
+            O_WRONLY | O_APPEND | O_CREAT, 0644);
+    sigprocmask(SIG_BLOCK, NULL, &mask);    // ours less the SIGCHLD
+    sigdelset(&mask, SIGCHLD);              //  blocked for signalfd
+    posix_spawnattr_setsigmask(&attr, &mask);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+    rc = posix_spawnp(&pid, args[0], &actions, &attr, args, environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    if (rc) {
+        errno = rc;
+        return -1;
+    }
+    return pid;
+}
+
+/*******************************************************
+ * int launchPidfd (pid_t pid)
+ *    - get a pidfd for a child
+ *
+ * returns:
+ *    pidfd
+ *    -1 if pidfds aren't available
+ *******************************************************/
+int launchPidfd(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    int fd;
+
+    // a child can't be reused before we reap it, so this is safe
+    if ((fd = syscall(SYS_pidfd_open, pid, 0)) != -1)
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+/*******************************************************
+ * int launchSignal (pid_t pid, int pidfd, int sig)
+ *    - signal a child
+ *
+ * returns:
+ *    0 if ok
+ *    -1 on error
+ *******************************************************/
+int launchSignal(pid_t pid, int pidfd, int sig)
+{
+#ifdef SYS_pidfd_send_signal
+    if (pidfd != -1)
+        return syscall(SYS_pidfd_send_signal, pidfd, sig, NULL, 0);
+#endif
+    return kill(pid, sig);
+}
+
+/*******************************************************
+ * int launchWait (pid_t pid, int pidfd, int stopped)
+ *    - wait for a child to stop or end
+ *
+ * returns:
+ *    0 if ok
+ *    -1 on error
+ *******************************************************/
+int launchWait(pid_t pid, int pidfd, int stopped)
+{
+    struct pollfd pfd;
+    siginfo_t info;
+    int status, rc;
+
+    if (pidfd == -1)
+        return waitpid(pid, &status, WUNTRACED) == -1 ? -1 : 0;
+
+    if (stopped) {
+        while ((rc = waitid(LAUNCH_P_PIDFD, pidfd, &info, WSTOPPED | WEXITED)) == -1 &&
+               errno == EINTR);
+        return rc;
+    }
+    pfd.fd = pidfd;                     // readable once it has exited
+    pfd.events = POLLIN;
+    while ((rc = poll(&pfd, 1, -1)) == -1 && errno == EINTR);
+    if (rc == -1)
+        return -1;
+    return waitid(LAUNCH_P_PIDFD, pidfd, &info, WEXITED | WNOHANG);
+}
+
+/*******************************************************
+ * int launchPoll (pid_t pid, int pidfd)
+ *    - collect a stop or end without waiting
+ *
+ * returns:
+ *    TRUE if it has stopped or ended
+ *    FALSE if it is still running
+ *******************************************************/
+int launchPoll(pid_t pid, int pidfd)
+{
+    siginfo_t info;
+    int rc;
+
+    info.si_pid = 0;                    // stays 0 if nothing to report
+    if (pidfd != -1)
+        rc = waitid(LAUNCH_P_PIDFD, pidfd, &info, WSTOPPED | WEXITED | WNOHANG);
+    else
+        rc = waitid(P_PID, pid, &info, WSTOPPED | WEXITED | WNOHANG);
+    return rc == -1 || info.si_pid != 0;
+}
@@ -0,0 +1,57 @@
+#ifndef LAUNCH_H
+#define LAUNCH_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  launch - process launch and control for HOST dispatcher
+
+  pid_t launchSpawn (char ** args, char * ans_file) - posix_spawn a process
+  int launchPidfd (pid_t pid) - get a pidfd for a child
+  int launchSignal (pid_t pid, int pidfd, int sig) - signal a child
+  int launchWait (pid_t pid, int pidfd, int stopped)
+      - wait for a child to end (or stop)
+  int launchPoll (pid_t pid, int pidfd) - has a child stopped or ended?
+
+  extern int LaunchMode; - LAUNCH_FORK or LAUNCH_SPAWN
+
+  see launch.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.1
+  history:
+     v1.0: posix_spawn backend, children tracked through pidfds
+     v1.1: launchPoll, collect a stop without waiting for it
+
+ *******************************************************************/
+
+#include <sys/types.h>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+/* launch definitions ******************************************/
+
+#define LAUNCH_FORK    0        /* fork, print pcb in child, execvp */
+#define LAUNCH_SPAWN   1        /* posix_spawnp with file actions */
+
+#define LAUNCH_ANS_FD  3        /* answer file descriptor of a spawned process */
+#define LAUNCH_ANS_ARG "&3"     /* 'process' answer file argument: use fd 3 */
+
+extern int LaunchMode;
+
+/* launch prototypes *******************************************/
+
+pid_t launchSpawn(char **, char *);
+int   launchPidfd(pid_t);
+int   launchSignal(pid_t, int, int);
+int   launchWait(pid_t, int, int);
+int   launchPoll(pid_t, int);
+
+#endif
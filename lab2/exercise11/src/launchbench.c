@@ -0,0 +1,109 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  launchbench - compare ways of starting a process
+
+  usage:
+
+    launchbench [-m MB] [-n count] [program [args]]
+
+  starts program (default /bin/true) count times (default 200) with
+  fork and execvp, as hostd does by default, and with launchSpawn
+  (posix_spawnp), and prints the mean microseconds the parent spends
+  starting each one and the mean until it has been reaped. -m touches
+  MB megabytes of heap first, as a dispatcher holding a large input
+  queue would have, to show how fork grows with the address space
+  while posix_spawn does not.
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: fork + execvp against posix_spawn
+
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "launch.h"
+
+static double Now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static pid_t Fork(char ** args)
+{
+    pid_t pid;
+
+    if ((pid = fork()) == 0) {
+        execvp(args[0], args);
+        perror(args[0]);
+        _exit(2);
+    }
+    return pid;
+}
+
+static pid_t Spawn(char ** args)
+{
+    return launchSpawn(args, NULL);
+}
+
+static void Bench(char * name, pid_t (*fn)(char **), char ** args, int count)
+{
+    double t0, t1, started = 0, reaped = 0;
+    int i, status;
+    pid_t pid;
+
+    for (i = 0; i < count; i++) {
+        t0 = Now();
+        if ((pid = fn(args)) == -1) { perror(name); exit(2); }
+        t1 = Now();
+        waitpid(pid, &status, 0);
+        started += t1 - t0;
+        reaped += Now() - t0;
+    }
+    printf("%-8s %6d runs %9.1f us to start %9.1f us to exit\n",
+        name, count, started / count * 1e6, reaped / count * 1e6);
+}
+
+int main(int argc, char * argv[])
+{
+    char * defaults[] = { "/bin/true", NULL };
+    char ** args = defaults;
+    long mb = 0;
+    int count = 200, i = 1;
+    char * heap;
+
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (!strcmp(argv[i], "-m") && i + 1 < argc)
+            mb = atol(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            count = atoi(argv[++i]);
+        else
+            break;
+    }
+    if (i < argc && argv[i][0] == '-') {
+        fprintf(stderr, "usage: %s [-m MB] [-n count] [program [args]]\n", argv[0]);
+        exit(127);
+    }
+    if (i < argc)
+        args = argv + i;
+    if (count < 1) count = 1;
+    if (mb > 0) {
+        if (!(heap = malloc(mb << 20))) { perror("malloc"); exit(2); }
+        memset(heap, 1, mb << 20);    // fault every page in
+    }
+    printf("%s: %ld MB touched, %d runs each\n", args[0], mb, count);
+    Bench("fork", Fork, args, count);
+    Bench("spawn", Spawn, args, count);
+    exit(0);
+}
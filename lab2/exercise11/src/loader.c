@@ -0,0 +1,281 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  loader - incremental dispatch file loader for HOST dispatcher
+
+   The dispatch file used to be read into the input queue in one go
+   before the first tick, so memory grew with the file and the first
+   job waited for the last line to be parsed. The loader instead reads
+   between ticks, stopping at the first job that arrives later than
+   timer + lookahead and keeping it pending. Only the jobs due within
+   the window are ever held, and a dispatch file of any length starts
+   straight away.
+
+   Jobs go onto an input heap ordered by arrival time (heap.c), so
+   several loaders can feed the same heap and a file need not be in
+   arrival order. Stopping at the first job beyond the window is only
+   safe if the file is sorted though, so a text file is checked when
+   it is opened (parseSorted, a memchr per line) and one that is out
+   of order is read in full by the first loadJobs. Each job's seq
+   records its file and its place in it, which orders jobs arriving
+   together.
+
+   A binary dispatch file (see jobfile.c) is recognised by its magic
+   and mapped instead of parsed; the jobs due are then found with the
+   file's arrival index and nothing is ever held pending. Binary files
+   are always sorted (hostd-convert sorts them).
+
+   int loadOpen (LoaderPtr l, char * file, char * ans_file, int lookahead,
+                 int source)
+      - open file (text or binary), jobs read will be given ans_file
+        as answer file; source is the file's place on the command line
+        (0, 1, ..) and orders its jobs after those of earlier files
+        arriving at the same time
+    returns:
+      TRUE if ok
+      FALSE if file could not be opened
+
+   int loadJobs (LoaderPtr l, PcbHeapPtr h, int timer)
+      - push on h every job arriving no later than timer + lookahead
+        (every job if the file is out of order)
+        (bad lines are reported by the parser and skipped)
+    returns:
+      number of jobs enqueued
+
+   int loadDone (LoaderPtr l)
+    returns:
+      TRUE if every job has been read and handed out
+      FALSE otherwise
+
+   int loadNextArrival (LoaderPtr l)
+      - read ahead (text files) to the next job not yet handed out
+    returns:
+      its arrival time
+      INT_MAX if every job has been handed out
+
+   void loadClose (LoaderPtr l)
+      - close the file and free any pending job
+    returns NONE
+
+   PcbPtr loadPcb (int * f, char * ans_file, long long seq)
+      - create the job described by the LOAD_FIELDS fields f (as read
+        from a dispatch file line), with answer file ans_file and seq
+    returns:
+      PcbPtr of new job
+      NULL if it could not be created
+
+ ********************************************************************
+
+  version: 1.7
+  history:
+     v1.0: read jobs a lookahead window at a time
+     v1.1: parse with parse.c instead of fgets/sscanf
+     v1.2: binary dispatch files
+     v1.3: input heap instead of queue, unsorted files, several loaders
+     v1.4: loadNextArrival, for the dispatcher's idle fast-forward
+     v1.5: optional ninth field, the job's tickets (by default
+           DEFAULT_TICKETS doubled for each priority level above the
+           lowest)
+     v1.6: optional tenth field, the ticks from arrival a (real-time)
+           job must end within
+     v1.7: loadPcb public, for jobs submitted through a socket
+
+ *******************************************************************/
+
+#include "loader.h"
+
+/*******************************************************
+ * PcbPtr loadPcb (int * f, char * ans_file, long long seq)
+ *    - create the job described by the LOAD_FIELDS fields f
+ *
+ * returns:
+ *    PcbPtr of new job
+ *    NULL if it could not be created
+ *******************************************************/
+PcbPtr loadPcb(int * f, char * ans_file, long long seq)
+{
+    PcbPtr process;
+
+    if (!(process = createnullPcb()))
+        return NULL;
+    process->arrivaltime = f[0];
+    process->priority = f[1];
+    process->remainingcputime = f[2];
+    process->mbytes = f[3];
+    process->req.printers = f[4];
+    process->req.scanners = f[5];
+    process->req.modems = f[6];
+    process->req.cds = f[7];
+    if (f[8] > 0)
+        process->tickets = f[8];
+    else if (f[1] >= HIGH_PRIORITY && f[1] < LOW_PRIORITY)
+        process->tickets = DEFAULT_TICKETS << (LOW_PRIORITY - f[1]);
+    if (f[9] > 0)
+        process->deadline = f[0] + f[9];
+    process->status = PCB_INITIALIZED;  // create successfully
+    process->ans_file = ans_file;
+    process->seq = seq;
+    return process;
+}
+
+/*******************************************************
+ * static PcbPtr loadNext (LoaderPtr l)
+ *    - read the next complete job from a text file
+ *
+ * returns:
+ *    PcbPtr of new job
+ *    NULL at end of file
+ *******************************************************/
+static PcbPtr loadNext(LoaderPtr l)
+{
+    int f[LOAD_FIELDS];
+    PcbPtr process;
+
+    int n;
+
+    if (l->open && (n = parseLine(&l->parser, f, LOAD_MIN_FIELDS, LOAD_FIELDS))) {
+        while (n < LOAD_FIELDS)
+            f[n++] = 0;                // no tickets or deadline given
+        if ((process = loadPcb(f, l->ans_file, l->seq++)))
+            return process;
+    }
+    if (l->open) {                     // end of file
+        parseClose(&l->parser);
+        l->open = FALSE;
+    }
+    return NULL;
+}
+
+/*******************************************************
+ * static int loadBinary (LoaderPtr l, PcbHeapPtr h, int timer)
+ *    - push the records of a binary file due by timer + lookahead
+ *
+ * returns:
+ *    number of jobs pushed on h
+ *******************************************************/
+static int loadBinary(LoaderPtr l, PcbHeapPtr h, int timer)
+{
+    int f[LOAD_FIELDS];
+    PcbPtr process;
+    size_t end;
+    int n = 0;
+
+    if (!l->open) return 0;
+    end = jobFind(&l->jobs, timer + l->lookahead, l->next);
+    for (; l->next < end; l->next++) {
+        jobRecord(&l->jobs, l->next, f);
+        if (!(process = loadPcb(f, l->ans_file, l->seq++)))
+            break;
+        if (!pushPcbHeap(h, process)) {
+            freePcb(process);
+            break;
+        }
+        n++;
+    }
+    if (l->next == l->jobs.count) {    // end of file
+        jobClose(&l->jobs);
+        l->open = FALSE;
+    }
+    return n;
+}
+
+/*******************************************************
+ * int loadOpen (LoaderPtr l, char * file, char * ans_file, int lookahead,
+ *               int source)
+ *    - open a dispatch file
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if file could not be opened
+ *******************************************************/
+int loadOpen(LoaderPtr l, char * file, char * ans_file, int lookahead,
+             int source)
+{
+    l->file = file;
+    l->ans_file = ans_file;
+    l->lookahead = lookahead;
+    l->pending = NULL;
+    l->next = 0;
+    l->seq = (long long) source << LOAD_SEQ_BITS;
+    l->sorted = TRUE;
+    if ((l->binary = jobIsBinary(file)))
+        return (l->open = jobOpen(&l->jobs, file));
+    if ((l->open = parseOpen(&l->parser, file)))
+        l->sorted = parseSorted(&l->parser);
+    return l->open;
+}
+
+/*******************************************************
+ * int loadJobs (LoaderPtr l, PcbHeapPtr h, int timer)
+ *    - read jobs due within the lookahead window
+ *
+ * returns:
+ *    number of jobs pushed on h
+ *******************************************************/
+int loadJobs(LoaderPtr l, PcbHeapPtr h, int timer)
+{
+    int n = 0;
+
+    if (l->binary)
+        return loadBinary(l, h, timer);
+    if (!l->pending)
+        l->pending = loadNext(l);
+    while (l->pending && (!l->sorted ||
+           l->pending->arrivaltime <= timer + l->lookahead)) {
+        if (!pushPcbHeap(h, l->pending))
+            break;
+        n++;
+        l->pending = loadNext(l);
+    }
+    return n;
+}
+
+/*******************************************************
+ * int loadDone (LoaderPtr l)
+ *
+ * returns:
+ *    TRUE if every job has been read and handed out
+ *******************************************************/
+int loadDone(LoaderPtr l)
+{
+    return !l->open && !l->pending;
+}
+
+/*******************************************************
+ * int loadNextArrival (LoaderPtr l)
+ *
+ * returns:
+ *    arrival time of the next job not yet handed out
+ *    INT_MAX if there is none
+ *******************************************************/
+int loadNextArrival(LoaderPtr l)
+{
+    int f[LOAD_FIELDS];
+
+    if (l->binary) {
+        if (!l->open) return INT_MAX;
+        jobRecord(&l->jobs, l->next, f);
+        return f[0];
+    }
+    if (!l->pending)
+        l->pending = loadNext(l);
+    return l->pending ? l->pending->arrivaltime : INT_MAX;
+}
+
+/*******************************************************
+ * void loadClose (LoaderPtr l)
+ *    - close the dispatch file
+ *
+ * returns NONE
+ *******************************************************/
+void loadClose(LoaderPtr l)
+{
+    if (l->open) {
+        if (l->binary) jobClose(&l->jobs);
+        else parseClose(&l->parser);
+    }
+    l->open = FALSE;
+    if (l->pending) freePcb(l->pending);
+    l->pending = NULL;
+}
@@ -0,0 +1,73 @@
+#ifndef LOADER_H
+#define LOADER_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  loader - incremental dispatch file loader for HOST dispatcher
+
+  int loadOpen (LoaderPtr l, char * file, char * ans_file, int lookahead,
+                int source) - open a text or binary dispatch file
+  int loadJobs (LoaderPtr l, PcbHeapPtr h, int timer) - read jobs due soon
+  int loadDone (LoaderPtr l) - check if every job has been read
+  int loadNextArrival (LoaderPtr l) - arrival of the next job not yet read
+  void loadClose (LoaderPtr l) - close the dispatch file
+  PcbPtr loadPcb (int * f, char * ans_file, long long seq)
+      - create the job described by the fields of a line
+
+  see loader.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.7
+  history:
+     v1.0: read jobs a lookahead window at a time
+     v1.1: parse with parse.c instead of fgets/sscanf
+     v1.2: binary dispatch files
+     v1.3: input heap instead of queue, unsorted files, several loaders
+     v1.4: loadNextArrival, for the dispatcher's idle fast-forward
+     v1.7: loadPcb public, for jobs submitted through a socket
+
+ *******************************************************************/
+
+#include <limits.h>
+#include "pcb.h"
+#include "heap.h"
+#include "parse.h"
+#include "jobfile.h"
+
+/* loader definitions ******************************************/
+
+#define DEFAULT_LOOKAHEAD 8     /* ticks of jobs read ahead of timer */
+#define LOAD_FIELDS      10     /* arrival, priority, cpu, mbytes, prn, scn, modem, cd, */
+                                /*  tickets, deadline */
+#define LOAD_MIN_FIELDS   8     /* tickets and deadline may be left out */
+#define LOAD_SEQ_BITS     40    /* pcb seq is source << LOAD_SEQ_BITS | job number */
+
+struct loader {
+    char * file;               // dispatch file name
+    int binary;                // TRUE for a binary dispatch file
+    Parser parser;             // the mapped text file
+    JobFile jobs;              // or the mapped binary file
+    size_t next;               // next record of the binary file
+    int open;                  // FALSE once every job has been read
+    char * ans_file;           // given to every pcb created
+    int lookahead;             // read jobs arriving up to timer + lookahead
+    int sorted;                // FALSE if the whole file must be read at once
+    long long seq;             // seq of the next job
+    PcbPtr pending;            // job read but not yet due
+};
+
+typedef struct loader Loader;
+typedef Loader * LoaderPtr;
+
+/* loader prototypes *******************************************/
+
+int  loadOpen(LoaderPtr, char *, char *, int, int);
+int  loadJobs(LoaderPtr, PcbHeapPtr, int);
+int  loadDone(LoaderPtr);
+int  loadNextArrival(LoaderPtr);
+void loadClose(LoaderPtr);
+PcbPtr loadPcb(int *, char *, long long);
+
+#endif
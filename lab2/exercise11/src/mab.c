@@ -19,6 +19,20 @@
  
     returns address of block or NULL if failure
 
+   MabPtr memPlace (MabPtr arena, int size);
+      - find where memAlloc would allocate size (the block is not
+        allocated, nor is the next fit position moved)
+
+    returns address of the free block memAlloc would split the
+      new block from the start of, or NULL if it would fail
+
+   int memFits (MabPtr arena, int size, MabPtr hold, int holdsize);
+      - check if size would fit once every block marked releasing
+        has been freed, with holdsize taken from the start of free
+        block hold (hold may be NULL)
+
+    returns TRUE/FALSE
+
    MabPtr memFree (MabPtr mab);
       - de-allocate a memory block
  
@@ -34,6 +48,12 @@
   
     returns m or NULL if unable to supply size bytes
 
+   int memAvail(MabPtr arena, int * largest, int * holes);
+      - total up the free blocks of arena, setting *largest to the
+        size of the largest and *holes to how many there are
+
+    returns free memory
+
    void memPrint(MabPtr arena);
       - print contents of memory arena
    no return
@@ -41,19 +61,31 @@
    extern enum memAllocAlg MabAlgorithm; - type of memory algorithm to use
      enum memAllocAlg { FIRST_FIT, NEXT_FIT, BEST_FIT, WORST_FIT};
 
+   extern Pool MabPool; - split blocks are allocated from here
+
+   extern int UserMemory; - most memory a user job may have, what
+     is left once real-time memory is reserved (USER_MEMORY_SIZE
+     unless the dispatcher reserves more)
+
 ********************************************************************
 
-  version: 1.0 (exercise 10)
+  version: 1.3
   date:    December 2003
   author:  Dr Ian G Graham, ian.graham@griffith.edu.au
   history:
      v1.0: Original for exercise 10
+     v1.1: Split blocks come from MabPool
+     v1.2: memPlace and memFits (what-if checks for backfilling)
+     v1.3: memAvail (free memory and fragmentation for tracing)
 
 *******************************************************************/
 
 #include "mab.h"
 
 enum memAllocAlg MabAlgorithm = FIRST_FIT;
+int UserMemory = USER_MEMORY_SIZE;
+
+Pool MabPool = POOL_INITIALIZER("mab", sizeof(Mab));
 
 static MabPtr next_mab = NULL;    // for NEXT_FIT algorithm
 
@@ -82,46 +114,28 @@ MabPtr memChk(MabPtr arena, int size)
  *******************************************************/
 int memChkMax(int size)
 {
-    return size > USER_MEMORY_SIZE ? FALSE : TRUE;
+    return size > UserMemory ? FALSE : TRUE;
 }      
 
 /*******************************************************
- * MabPtr memAlloc (MabPtr arena, int size);
- *    - allocate a memory block
+ * MabPtr memPlace (MabPtr arena, int size);
+ *    - find where memAlloc would allocate a memory block
  *
- * returns address of block or NULL if failure
+ * returns address of free block or NULL if failure
  *******************************************************/
-MabPtr memAlloc(MabPtr arena, int size)
+MabPtr memPlace(MabPtr arena, int size)
 {
     MabPtr m;
 
     // First Fit
     if (MabAlgorithm == FIRST_FIT) {
-        if ((m = memChk(arena, size)) &&
-        (m = memSplit(m, size)))
-            m->allocated = TRUE;
-        return m;
+        return memChk(arena, size);
     }
     // Next Fit
     else if (MabAlgorithm == NEXT_FIT) {
-
-        if (!next_mab)
-            next_mab = arena;  // initialize next_mab
-        if ((m = memChk(next_mab, size)) &&  // split from next_mab
-        (m = memSplit(m, size))) 
-        {
-            m->allocated = TRUE;
-            next_mab = m->next;
+        if ((m = memChk(next_mab ? next_mab : arena, size)))  // from next_mab
             return m;
-        }
-        else if ((m = memChk(arena, size)) &&  // else split from head
-        (m = memSplit(m, size)))
-        {
-            m->allocated = TRUE;
-            next_mab = m->next;
-            return m;
-        }
-        return NULL;
+        return memChk(arena, size);  // else from head
     }
     // Best Fit
     else if (MabAlgorithm == BEST_FIT) {
@@ -136,9 +150,7 @@ MabPtr memAlloc(MabPtr arena, int size)
             }
             arena = arena->next;
         }
-        if ((m = memSplit(p, size)))
-            m->allocated = TRUE;
-        return m;
+        return p;
     }
     // Worst Fit
     else if (MabAlgorithm == WORST_FIT) {
@@ -153,14 +165,54 @@ MabPtr memAlloc(MabPtr arena, int size)
             }
             arena = arena->next;
         }
-        if ((m = memSplit(p, size)))
-            m->allocated = TRUE;
-        return m;
+        return p;
     }
     else
         return NULL;
 }
 
+/*******************************************************
+ * MabPtr memAlloc (MabPtr arena, int size);
+ *    - allocate a memory block
+ *
+ * returns address of block or NULL if failure
+ *******************************************************/
+MabPtr memAlloc(MabPtr arena, int size)
+{
+    MabPtr m;
+
+    if ((m = memSplit(memPlace(arena, size), size))) {
+        m->allocated = TRUE;
+        if (MabAlgorithm == NEXT_FIT)
+            next_mab = m->next;
+    }
+    return m;
+}
+
+/*******************************************************
+ * int memFits (MabPtr arena, int size, MabPtr hold, int holdsize);
+ *    - check if size would fit after releasing blocks
+ *
+ * returns TRUE/FALSE
+ *******************************************************/
+int memFits(MabPtr arena, int size, MabPtr hold, int holdsize)
+{
+    int run = 0;  // bytes free (or to be) back to the last block in use
+
+    while (arena) {
+        if (arena->allocated && !arena->releasing)
+            run = 0;
+        else if (arena == hold)
+            run = arena->size - holdsize;
+        else
+            run += arena->size;
+        if (run >= size)
+            return TRUE;
+        arena = arena->next;
+    }
+    return FALSE;
+}
+
 /*******************************************************
  * MabPtr memFree (MabPtr mab);
  *    - de-allocate a memory block
@@ -196,7 +248,7 @@ MabPtr memMerge(MabPtr m)
         if (MabAlgorithm == NEXT_FIT &&     
             next_mab == n) next_mab = m;
 
-        free (n);
+        poolFree (&MabPool, n);
         if (m->next) (m->next)->prev = m;
     }
     return m;
@@ -214,7 +266,7 @@ MabPtr memSplit(MabPtr m, int size)
     
     if (m) {
         if (m->size > size) {
-            n = (MabPtr) malloc( sizeof(Mab) );
+            n = (MabPtr) poolAlloc( &MabPool );
             if (!n) {
                 fprintf(stderr,"memory allocation error\n");
                 exit(127);
@@ -223,6 +275,7 @@ MabPtr memSplit(MabPtr m, int size)
             n->size = m->size - size;
             m->size = size;
             n->allocated = m->allocated;
+            n->releasing = m->releasing;
             n->next = m->next;
             m->next = n;
             n->prev = m;
@@ -233,6 +286,28 @@ MabPtr memSplit(MabPtr m, int size)
     return NULL;    
 }
 
+/*******************************************************
+ * int memAvail(MabPtr arena, int * largest, int * holes);
+ *    - free memory, largest free block and number of them
+ *
+ * returns free memory
+ *******************************************************/
+int memAvail(MabPtr arena, int * largest, int * holes)
+{
+    int total = 0;
+
+    *largest = *holes = 0;
+    for (; arena; arena = arena->next) {
+        if (arena->allocated)
+            continue;
+        total += arena->size;
+        (*holes)++;
+        if (arena->size > *largest)
+            *largest = arena->size;
+    }
+    return total;
+}
+
 /*******************************************************
  * void memPrint(MabPtr arena);
  *    - print contents of memory arena
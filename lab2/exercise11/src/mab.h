@@ -9,27 +9,38 @@
   MabPtr memChk (MabPtr arena, int size); - check for memory available
   int memChkMax (int size); - check for over max memory
   MabPtr memAlloc (MabPtr arena, int size); - allocate a memory block
+  MabPtr memPlace (MabPtr arena, int size); - where memAlloc would allocate
+  int memFits (MabPtr arena, int size, MabPtr hold, int holdsize);
+      - check for memory available once blocks marked releasing are freed
   MabPtr memFree (MabPtr mab); - de-allocate a memory block
   MabPtr memMerge(Mabptr m); - merge m with m->next
   MabPtr memSplit(Mabptr m, int size); - split m into two
+  int memAvail(MabPtr arena, int * largest, int * holes);
+      - free memory, largest free block and number of free blocks
   void memPrint(MabPtr arena); - print contents of memory arena
 
   extern enum memAllocAlg MabAlgorithm; - type of memory algorithm to use
+  extern Pool MabPool; - pool that split blocks are allocated from
+  extern int UserMemory; - most memory a user job may have
 
   see mab.c for fuller description of function arguments and returns
 
 ********************************************************************
 
-  version: 1.0 (exercise 10)
+  version: 1.3
   date:    December 2003
   author:  Dr Ian G Graham, ian.graham@griffith.edu.au
   history:
      v1.0: Original for exercise 10
+     v1.1: Split blocks come from MabPool
+     v1.2: memPlace and memFits (what-if checks for backfilling)
+     v1.3: memAvail (free memory and fragmentation for tracing)
 
 *******************************************************************/
 
 #include <stdlib.h>
 #include <stdio.h>
+#include "pool.h"
 
 #ifndef FALSE
 #define FALSE 0
@@ -42,6 +53,8 @@
 enum memAllocAlg { FIRST_FIT, NEXT_FIT, BEST_FIT, WORST_FIT};
 
 extern enum memAllocAlg MabAlgorithm;
+extern Pool MabPool;
+extern int UserMemory;
 
 /* memory management *******************************/
 
@@ -55,6 +68,7 @@ struct mab {
     int allocated;
     struct mab * next;
     struct mab * prev;
+    int releasing;        // expected to be freed (memFits only)
 };
 
 typedef struct mab Mab;
@@ -65,8 +79,11 @@ typedef Mab * MabPtr;
 MabPtr memChk(MabPtr, int);
 int    memChkMax(int);  
 MabPtr memAlloc(MabPtr, int);
+MabPtr memPlace(MabPtr, int);
+int    memFits(MabPtr, int, MabPtr, int);
 MabPtr memFree(MabPtr);
 MabPtr memMerge(MabPtr);   
 MabPtr memSplit(MabPtr, int);
+int    memAvail(MabPtr, int *, int *);
 void   memPrint(MabPtr);
 #endif
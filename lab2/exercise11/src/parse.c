@@ -0,0 +1,350 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  parse - dispatch file parser for HOST dispatcher
+
+   A dispatch file is lines of comma separated integers. fscanf spends
+   most of its time in locale and format handling and gives no hint of
+   which line was wrong. Here the file is mmap'ed and the ',' and '\n'
+   delimiters are found sixteen bytes at a time (SSE2 compare and
+   movemask where available, a plain loop otherwise). The fields
+   between them are converted by hand. A bad line is reported on
+   stderr as file:line:column and skipped.
+
+   int parseOpen (ParserPtr p, char * file)
+      - map file for reading (files that can't be mapped, such as
+        pipes, are read into memory instead)
+    returns:
+      TRUE if ok
+      FALSE if file could not be opened or read
+
+   int parseBuffer (ParserPtr p, char * name, char * buffer, size_t size)
+      - parse size bytes of malloc'ed buffer (called name in error
+        messages) as if they were a file; parseClose frees buffer
+    returns:
+      TRUE
+
+   int parseLine (ParserPtr p, int * fields, int min, int max)
+      - parse the next line that is not blank into fields[0..]; a line
+        with a bad number or fewer than min or more than max fields
+        is reported and skipped
+    returns:
+      number of fields parsed (min .. max)
+      0 at end of file
+
+   int parseSorted (ParserPtr p)
+      - check that the first field of the lines from the next one on
+        never decreases (lines not starting with a number are ignored,
+        parseLine will report them)
+    returns:
+      TRUE if so
+      FALSE if any line's first field is less than an earlier one's
+
+   void parseClose (ParserPtr p)
+      - unmap (or free) the file
+    returns NONE
+
+ ********************************************************************
+
+  version: 1.2
+  history:
+     v1.0: mmap + vectorised delimiter scan, errors with line and column
+     v1.1: parseSorted
+     v1.2: parseBuffer, lines already in memory (submission socket)
+
+ *******************************************************************/
+
+#include "parse.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*******************************************************
+ * static unsigned int delimMask (ParserPtr p, size_t at)
+ *    - find the delimiters in the block starting at offset at
+ *
+ * returns bit n set if byte at + n is ',' or '\n'
+ *******************************************************/
+static unsigned int delimMask(ParserPtr p, size_t at)
+{
+    unsigned int mask = 0;
+    size_t n, end = p->size - at;
+
+#ifdef __SSE2__
+    if (end >= PARSE_BLOCK) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (p->base + at));
+        __m128i d = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+        return (unsigned int) _mm_movemask_epi8(d);
+    }
+#endif
+    if (end > PARSE_BLOCK) end = PARSE_BLOCK;
+    for (n = 0; n < end; n++)
+        if (p->base[at + n] == ',' || p->base[at + n] == '\n')
+            mask |= 1u << n;
+    return mask;
+}
+
+/*******************************************************
+ * static size_t nextDelim (ParserPtr p, size_t from)
+ *    - find the first ',' or '\n' at or after offset from
+ *
+ * returns its offset, or p->size if there is none
+ *******************************************************/
+static size_t nextDelim(ParserPtr p, size_t from)
+{
+    size_t at = from - from % PARSE_BLOCK;
+    unsigned int m;
+
+    if (from >= p->size) return p->size;
+    if (at != p->block) {
+        p->block = at;
+        p->mask = delimMask(p, at);
+    }
+    m = p->mask & (~0u << (from - at));
+    while (!m) {
+        p->block += PARSE_BLOCK;
+        if (p->block >= p->size) return p->size;
+        m = p->mask = delimMask(p, p->block);
+    }
+    return p->block + __builtin_ctz(m);
+}
+
+/*******************************************************
+ * static void parseError (ParserPtr p, size_t at, char * msg)
+ *    - report a bad line, at is the offset of the culprit
+ *******************************************************/
+static void parseError(ParserPtr p, size_t at, char * msg)
+{
+    fprintf(stderr, "ERROR - %s:%d:%d: %s\n",
+        p->file, p->line, (int) (at - p->pos) + 1, msg);
+    p->errors++;
+}
+
+/*******************************************************
+ * static char * parseInt (const char * s, size_t * at, size_t end, int * value)
+ *    - convert s[*at..end) (blanks allowed around an optional sign
+ *      and the digits) to an int
+ *
+ * returns:
+ *    NULL if ok
+ *    what is wrong, with *at set to the first bad character
+ *******************************************************/
+static char * parseInt(const char * s, size_t * at, size_t end, int * value)
+{
+    long long v = 0;
+    int negative = FALSE;
+    size_t i = *at, digits;
+
+    while (i < end && (s[i] == ' ' || s[i] == '\t')) i++;
+    if (i < end && (s[i] == '-' || s[i] == '+'))
+        negative = s[i++] == '-';
+    for (digits = i; i < end && s[i] >= '0' && s[i] <= '9'; i++)
+        if ((v = v * 10 + (s[i] - '0')) > (long long) INT_MAX + negative) {
+            *at = digits;
+            return "number out of range";
+        }
+    if (i == digits) {
+        *at = i;
+        return "expected a number";
+    }
+    while (i < end && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r')) i++;
+    if (i != end) {
+        *at = i;
+        return "unexpected character after number";
+    }
+    *value = (int) (negative ? -v : v);
+    return NULL;
+}
+
+/*******************************************************
+ * int parseOpen (ParserPtr p, char * file)
+ *    - map a dispatch file
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if file could not be opened or read
+ *******************************************************/
+int parseOpen(ParserPtr p, char * file)
+{
+    struct stat st;
+    char * buffer = NULL;
+    size_t size = 0, room = 0;
+    ssize_t n;
+    int fd;
+
+    parseBuffer(p, file, NULL, 0);
+    if ((fd = open(file, O_RDONLY)) == -1)
+        return FALSE;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size > 0) {
+            p->base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p->base == MAP_FAILED) {
+                close(fd);
+                p->base = NULL;
+                return FALSE;
+            }
+            madvise((void *) p->base, st.st_size, MADV_SEQUENTIAL);
+            p->size = st.st_size;
+            p->mapped = TRUE;
+        }
+        close(fd);
+        return TRUE;
+    }
+
+    for (;;) {                         // pipe etc: read it all in
+        if (size == room) {
+            room = room ? room * 2 : 65536;
+            if (!(buffer = realloc(buffer, room))) {
+                close(fd);
+                return FALSE;
+            }
+        }
+        if ((n = read(fd, buffer + size, room - size)) <= 0) break;
+        size += n;
+    }
+    close(fd);
+    p->base = buffer;
+    p->size = size;
+    return TRUE;
+}
+
+/*******************************************************
+ * int parseBuffer (ParserPtr p, char * name, char * buffer, size_t size)
+ *    - parse lines already in memory
+ *
+ * returns TRUE
+ *******************************************************/
+int parseBuffer(ParserPtr p, char * name, char * buffer, size_t size)
+{
+    p->file = name;
+    p->base = buffer;
+    p->size = size;
+    p->pos = 0;
+    p->mapped = FALSE;
+    p->line = 1;
+    p->block = (size_t) -1;
+    p->mask = 0;
+    p->errors = 0;
+    return TRUE;
+}
+
+/*******************************************************
+ * int parseLine (ParserPtr p, int * fields, int min, int max)
+ *    - parse the next line that is not blank
+ *
+ * returns:
+ *    number of fields parsed (min .. max)
+ *    0 at end of file
+ *******************************************************/
+int parseLine(ParserPtr p, int * fields, int min, int max)
+{
+    size_t at, end, bad;
+    int n;
+    char msg[64], * error;
+    const char * s = p->base;
+
+    while (p->pos < p->size) {
+        n = 0;
+        at = p->pos;
+        for (;;) {
+            end = nextDelim(p, at);
+            if (n == max) {
+                parseError(p, at, "too many fields");
+                break;
+            }
+            bad = at;
+            if ((error = parseInt(s, &bad, end, &fields[n]))) {
+                for (at = p->pos; at < end &&
+                     (s[at] == ' ' || s[at] == '\t' || s[at] == '\r'); at++);
+                if (n || at != end || (end != p->size && s[end] != '\n'))
+                    parseError(p, bad, error);
+                break;                         // (else a blank line)
+            }
+            n++;
+            if (end == p->size || s[end] == '\n') {
+                if (n >= min) {
+                    p->pos = end + 1;
+                    p->line++;
+                    return n;
+                }
+                if (min == max)
+                    sprintf(msg, "%d fields, expected %d", n, min);
+                else
+                    sprintf(msg, "%d fields, expected %d to %d", n, min, max);
+                parseError(p, end, msg);
+                break;
+            }
+            at = end + 1;
+        }
+        // skip the rest of a blank or bad line
+        while ((end = nextDelim(p, end)) < p->size && s[end] != '\n')
+            end++;
+        p->pos = end + 1;
+        p->line++;
+    }
+    return 0;
+}
+
+/*******************************************************
+ * int parseSorted (ParserPtr p)
+ *    - check the rest of the file is in order of first field
+ *
+ * returns:
+ *    TRUE if it is
+ *    FALSE if not
+ *******************************************************/
+int parseSorted(ParserPtr p)
+{
+    const char * s = p->base, * nl;
+    size_t at = p->pos, i;
+    long long v, last = LLONG_MIN;
+    int negative;
+
+    while (at < p->size) {
+        for (i = at; i < p->size && (s[i] == ' ' || s[i] == '\t'); i++);
+        if (i < p->size && (s[i] == '-' || s[i] == '+'))
+            negative = s[i++] == '-';
+        else
+            negative = FALSE;
+        if (i < p->size && s[i] >= '0' && s[i] <= '9') {
+            for (v = 0; i < p->size && s[i] >= '0' && s[i] <= '9' && v <= INT_MAX; i++)
+                v = v * 10 + (s[i] - '0');
+            if (negative) v = -v;
+            if (v < last)
+                return FALSE;
+            last = v;
+        }
+        if (!(nl = memchr(s + i, '\n', p->size - i)))
+            break;
+        at = nl - s + 1;
+    }
+    return TRUE;
+}
+
+/*******************************************************
+ * void parseClose (ParserPtr p)
+ *    - unmap the file
+ *
+ * returns NONE
+ *******************************************************/
+void parseClose(ParserPtr p)
+{
+    if (p->base) {
+        if (p->mapped)
+            munmap((void *) p->base, p->size);
+        else
+            free((void *) p->base);
+    }
+    p->base = NULL;
+    p->size = p->pos = 0;
+}
@@ -0,0 +1,65 @@
+#ifndef PARSE_H
+#define PARSE_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  parse - dispatch file parser for HOST dispatcher
+
+  int parseOpen (ParserPtr p, char * file) - map a dispatch file
+  int parseBuffer (ParserPtr p, char * name, char * buffer, size_t size)
+      - parse lines already in memory
+  int parseLine (ParserPtr p, int * fields, int min, int max) - parse a line
+  int parseSorted (ParserPtr p) - check lines are in order of first field
+  void parseClose (ParserPtr p) - unmap the file
+
+  see parse.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.2
+  history:
+     v1.0: mmap + vectorised delimiter scan, errors with line and column
+     v1.1: parseSorted
+     v1.2: parseBuffer, lines already in memory (submission socket)
+
+ *******************************************************************/
+
+#include <stddef.h>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+/* parser definitions ******************************************/
+
+#define PARSE_BLOCK 16          /* bytes looked at per delimiter scan */
+
+struct parser {
+    char * file;               // for error messages
+    const char * base;         // the whole file
+    size_t size;               // its length
+    int mapped;                // TRUE if base is mmap'ed, else malloc'ed
+    size_t pos;                // start of the next line
+    int line;                  // number of the next line
+    size_t block;              // offset of the block scanned last
+    unsigned int mask;         // delimiters in that block, one bit a byte
+    int errors;                // lines rejected
+};
+
+typedef struct parser Parser;
+typedef Parser * ParserPtr;
+
+/* parser prototypes *******************************************/
+
+int  parseOpen(ParserPtr, char *);
+int  parseBuffer(ParserPtr, char *, char *, size_t);
+int  parseLine(ParserPtr, int *, int, int);
+int  parseSorted(ParserPtr);
+void parseClose(ParserPtr);
+
+#endif
@@ -0,0 +1,110 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  parsebench - compare dispatch file parsers
+
+  usage:
+
+    parsebench <dispatch file> [repeats]
+
+  parses the file [repeats] times (default 5) with the fscanf loop
+  hostd used to use and with parse.c, and prints the best MB/s of
+  each together with a checksum of the fields read so the two can be
+  seen to agree.
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: fscanf against parse.c
+
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "parse.h"
+
+#define FIELDS 8
+
+static double Now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/* the step 3 loop of hostd before the parser, less the pcbs */
+static long long ScanfFile(char * file, long * lines)
+{
+    FILE * stream = fopen(file, "r");
+    int f[FIELDS], i;
+    long long sum = 0;
+
+    if (!stream) { perror(file); exit(2); }
+    *lines = 0;
+    while (!feof(stream)) {
+        if (fscanf(stream, "%d, %d, %d, %d, %d, %d, %d, %d",
+             &f[0], &f[1], &f[2], &f[3], &f[4], &f[5], &f[6], &f[7]) != FIELDS)
+            continue;
+        for (i = 0; i < FIELDS; i++) sum += f[i];
+        (*lines)++;
+    }
+    fclose(stream);
+    return sum;
+}
+
+static long long ParseFile(char * file, long * lines)
+{
+    Parser p;
+    int f[FIELDS], i;
+    long long sum = 0;
+
+    if (!parseOpen(&p, file)) { perror(file); exit(2); }
+    *lines = 0;
+    while (parseLine(&p, f, FIELDS, FIELDS)) {
+        for (i = 0; i < FIELDS; i++) sum += f[i];
+        (*lines)++;
+    }
+    parseClose(&p);
+    return sum;
+}
+
+static void Bench(char * name, long long (*fn)(char *, long *),
+                  char * file, double mb, int repeats)
+{
+    double t, best = 0;
+    long long sum = 0;
+    long lines = 0;
+    int r;
+
+    for (r = 0; r < repeats; r++) {
+        t = Now();
+        sum = fn(file, &lines);
+        t = Now() - t;
+        if (!r || t < best) best = t;
+    }
+    printf("%-8s %10ld lines %9.1f MB/s %12.0f lines/s  checksum %lld\n",
+        name, lines, mb / best, lines / best, sum);
+}
+
+int main(int argc, char * argv[])
+{
+    struct stat st;
+    int repeats = argc > 2 ? atoi(argv[2]) : 5;
+    double mb;
+
+    if (argc < 2 || repeats < 1) {
+        fprintf(stderr, "usage: %s <dispatch file> [repeats]\n", argv[0]);
+        exit(127);
+    }
+    if (stat(argv[1], &st) == -1) { perror(argv[1]); exit(2); }
+    mb = st.st_size / 1e6;
+    printf("%s: %.1f MB, best of %d\n", argv[1], mb, repeats);
+    Bench("fscanf", ScanfFile, argv[1], mb, repeats);
+    Bench("parse", ParseFile, argv[1], mb, repeats);
+    exit(0);
+}
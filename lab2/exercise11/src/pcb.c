@@ -14,6 +14,18 @@
       PcbPtr of process
       NULL if suspend failed
 
+   PcbPtr stopPcb(PcbPtr process) - suspend a process without
+      waiting for it to stop (see stoppedPcb). its cpu is free to
+      start or continue another process straight away
+    returns:
+      PcbPtr of process
+
+   PcbPtr stoppedPcb(PcbPtr process, int wait) - see the stop of a
+      process sent SIGTSTP by stopPcb (waiting for it if wait is TRUE)
+    returns:
+      PcbPtr of process if it has stopped (or ended)
+      NULL if it has not stopped yet
+
    PcbPtr terminatePcb(PcbPtr process) - terminate a process
     returns:
       PcbPtr of process
@@ -31,33 +43,93 @@
    PcbPtr createnullPcb(void) - create inactive Pcb.
     returns:
       PcbPtr of newly initialised Pcb
-      NULL if malloc failed
+      NULL if allocation failed
+
+   void freePcb(PcbPtr process) - give Pcb back to PcbPool
+    returns:
+      void
+
+   queues with head and tail pointers (all O(1)):
 
-   PcbPtr enqPcb (PcbPtr headofQ, PcbPtr process)
-      - queue process (or join queues) at end of queue
-      - enqueues at "tail" of queue. 
-    returns head of queue
+   void initPcbQueue (PcbQueuePtr q) - make q an empty queue
 
-   PcbPtr deqPcb (PcbPtr * headofQ);
-      - dequeue process - take Pcb from "head" of queue.
+   PcbPtr enqPcbQueue (PcbQueuePtr q, PcbPtr process)
+      - enqueue process at tail of q
+    returns process
+
+   PcbPtr deqPcbQueue (PcbQueuePtr q)
+      - dequeue process from head of q
     returns:
       PcbPtr if dequeued,
       NULL if queue was empty
-      & sets new head of Q pointer in adrs at 1st arg
+
+   PcbPtr rmPcbQueue (PcbQueuePtr q, PcbPtr process)
+      - take process out of q wherever it is
+    returns process
+
+   PcbPtr insPcbQueue (PcbQueuePtr q, PcbPtr process, PcbBefore before)
+      - insert process in q, kept in before(a, b) order, after any
+        equal to it; O(n) but searched from the tail, so O(1) for a
+        process going after all the others
+    returns process
+
+   arrays of queues, one per priority level, with a bitmap of the
+   levels that are not empty:
+
+   void initPcbLevels (PcbLevelsPtr l) - make every level empty
+
+   PcbPtr enqPcbLevel (PcbLevelsPtr l, PcbPtr process, int level)
+      - enqueue process at tail of level
+    returns process
+
+   PcbPtr deqPcbLevel (PcbLevelsPtr l, int level)
+      - dequeue process from head of level
+    returns:
+      PcbPtr if dequeued,
+      NULL if level was empty
+
+   PcbPtr rmPcbLevel (PcbLevelsPtr l, PcbPtr process, int level)
+      - take process out of level wherever it is
+    returns process
+
+   int topPcbLevel (PcbLevelsPtr l)
+    returns highest priority (lowest numbered) non-empty level
+            -1 if every level is empty
+
+   int countPcbLevels (PcbLevelsPtr l, int n)
+    returns number of processes in levels 0 .. n - 1
 
  ********************************************************************
 
-   version: 1.2 (exercise 11 and final project version)
+   version: 1.15
    date:    December 2003
    author:  Dr Ian G Graham, ian.graham@griffith.edu.au
    history:
       v1.0: Original for exercises 7, 8, & 9 
       v1.1: Add reference to memory block structure for exercise 10
       v1.2: Add resource allocation for exercise 11
+      v1.3: Simulated processes (see sim.c)
+      v1.4: Remember last cpu for work stealing
+      v1.5: O(1) PcbQueue and PcbLevels (head/tail, non-empty bitmap)
+      v1.6: Pcbs come from PcbPool, nick name kept in the Pcb
+      v1.7: seq, input order for ties between processes
+      v1.8: Start jobs on parked workers when there are any (worker.c)
+      v1.9: posix_spawn launch, processes signalled through a pidfd
+      v1.10: stopPcb/stoppedPcb, suspend without waiting for the stop
+      v1.11: PcbLevels hold up to MAX_QUEUES levels (set at run time)
+      v1.12: tickets and pass for proportional share scheduling
+      v1.13: red-black tree links (see rbtree.c)
+      v1.14: deadline, insPcbQueue for an ordered (EDF) queue
+      v1.15: admission, dispatch and suspend times for statistics
 
  *******************************************************************/
 
 #include "pcb.h"
+#include "sim.h"
+#include "worker.h"
+#include "launch.h"
+
+Pool PcbPool = POOL_INITIALIZER("pcb", sizeof(Pcb));
 
 /*******************************************************
  * PcbPtr startPcb(PcbPtr process) - start (or restart)
@@ -68,26 +140,67 @@
  ******************************************************/
 PcbPtr startPcb (PcbPtr p) 
 { 
+    static pid_t simpid = 0;
+    sigset_t mask;
+
+    if (SimMode) {                     // simulated, no child
+        if (p->pid == 0) {
+            p->pid = ++simpid;
+            p->args[1] = getPcbNickName(p);
+            simAnswer(p, "START");
+        } else
+            simAnswer(p, "SIGCONT");
+        p->status = PCB_RUNNING;
+        return p;
+    }
+
     if (p->pid == 0) {                 // not yet started
+        p->args[1] = getPcbNickName(p);
+        if ((p->pid = workStart(p->args[1], p->ans_file, WORK_TICKS))) {
+            p->pidfd = launchPidfd(p->pid);
+            p->status = PCB_RUNNING;   // on a parked worker
+            printPcbHdr(stdout);
+            printPcb(p, stdout);
+            fflush(stdout);
+            return p;
+        }
+        if (LaunchMode == LAUNCH_SPAWN) {
+            p->args[2] = LAUNCH_ANS_ARG;  // opened on LAUNCH_ANS_FD
+            if ((p->pid = launchSpawn(p->args, p->ans_file)) == -1) {
+                perror ("startPcb");
+                exit(1);
+            }
+            p->pidfd = launchPidfd(p->pid);
+            p->status = PCB_RUNNING;
+            printPcbHdr(stdout);
+            printPcb(p, stdout);
+            fflush(stdout);
+            return p;
+        }
         switch (p->pid = fork ()) {    //  so start it
             case -1: 
                 perror ("startPcb");
                 exit(1); 
             case 0:                             // child 
+                sigemptyset(&mask);             // don't pass on the
+                sigaddset(&mask, SIGCHLD);      //  dispatcher's blocked
+                sigprocmask(SIG_UNBLOCK, &mask, NULL);  //  SIGCHLD
                 p->pid = getpid();
                 p->status = PCB_RUNNING;
                 printPcbHdr(stdout);            // printout in child to
                 printPcb(p, stdout);            //  sync with o/p
                 fflush(stdout);
-                p->args[1] = getPcbNickName(p);
                 p->args[2] = p->ans_file;
                 execvp (p->args[0], p->args); 
                 perror (p->args[0]);
                 exit (2);
         }                                       // parent         
+        p->pidfd = launchPidfd(p->pid);
 
     } else { // already started & suspended so continue
-        kill (p->pid, SIGCONT);
+        if (p->stopping)               // SIGCONT would cancel a pending SIGTSTP
+            stoppedPcb(p, TRUE);
+        launchSignal(p->pid, p->pidfd, SIGCONT);
     }    
     p->status = PCB_RUNNING;
     return p; 
@@ -102,13 +215,51 @@ PcbPtr startPcb (PcbPtr p)
  ******************************************************/
  PcbPtr suspendPcb(PcbPtr p)
  {
-     int status;
-     
-     kill(p->pid, SIGTSTP);
-     waitpid(p->pid, &status, WUNTRACED);
+     if (SimMode) {
+         simAnswer(p, "SIGTSTP");
+         p->status = PCB_SUSPENDED;
+         return p;
+     }
+     launchSignal(p->pid, p->pidfd, SIGTSTP);
+     launchWait(p->pid, p->pidfd, TRUE);
      p->status = PCB_SUSPENDED;
      return p;
  }
+
+/*******************************************************
+ * PcbPtr stopPcb(PcbPtr process) - suspend a process
+ *    without waiting for it to stop
+ * returns:
+ *    PcbPtr of process
+ ******************************************************/
+PcbPtr stopPcb(PcbPtr p)
+{
+    if (SimMode)                     // nothing to wait for anyway
+        return suspendPcb(p);
+    launchSignal(p->pid, p->pidfd, SIGTSTP);
+    p->stopping = TRUE;
+    p->status = PCB_SUSPENDED;
+    return p;
+}
+
+/*******************************************************
+ * PcbPtr stoppedPcb(PcbPtr process, int wait) - see the
+ *    stop of a process sent SIGTSTP by stopPcb
+ * returns:
+ *    PcbPtr of process if it has stopped
+ *    NULL if not yet (only if wait is FALSE)
+ ******************************************************/
+PcbPtr stoppedPcb(PcbPtr p, int wait)
+{
+    if (p->stopping) {
+        if (wait)
+            launchWait(p->pid, p->pidfd, TRUE);
+        else if (!launchPoll(p->pid, p->pidfd))
+            return NULL;
+        p->stopping = FALSE;
+    }
+    return p;
+}
  
 /*******************************************************
  * PcbPtr terminatePcb(PcbPtr process) - terminate
@@ -119,10 +270,14 @@ PcbPtr startPcb (PcbPtr p)
  ******************************************************/
 PcbPtr terminatePcb(PcbPtr p)
 {
-    int status;
-    
-    kill(p->pid, SIGINT);
-    waitpid(p->pid, &status, WUNTRACED);
+    if (SimMode) {                   // already gone if it ran out of ticks
+        if (p->status != PCB_TERMINATED)
+            simAnswer(p, "SIGINT");
+        p->status = PCB_TERMINATED;
+        return p;
+    }
+    launchSignal(p->pid, p->pidfd, SIGINT);
+    launchWait(p->pid, p->pidfd, FALSE);
     p->status = PCB_TERMINATED;
     return p;
 }  
@@ -184,21 +339,32 @@ void printPcbHdr(FILE * iostream)
  *
  * returns:
  *    PcbPtr of newly initialised Pcb
- *    NULL if malloc failed
+ *    NULL if allocation failed
  ******************************************************/
  
 PcbPtr createnullPcb()
 {
     PcbPtr newprocessPtr;
       
-    if ((newprocessPtr = (PcbPtr) malloc (sizeof(Pcb)))) {
+    if ((newprocessPtr = (PcbPtr) poolAlloc (&PcbPool))) {
         newprocessPtr->pid = 0;
+        newprocessPtr->pidfd = -1;
         newprocessPtr->args[0] = DEFAULT_PROCESS;
         newprocessPtr->args[1] = NULL;
         newprocessPtr->args[2] = NULL;
+        newprocessPtr->args[3] = NULL;
+        newprocessPtr->nickname[0] = '\0';
         newprocessPtr->arrivaltime = 0;
         newprocessPtr->priority = HIGH_PRIORITY;
         newprocessPtr->remainingcputime = 0;
+        newprocessPtr->tickets = DEFAULT_TICKETS;
+        newprocessPtr->pass = 0;
+        newprocessPtr->deadline = INT_MAX;
+        newprocessPtr->tier = HIGH_PRIORITY;
+        newprocessPtr->admitted = -1;
+        newprocessPtr->started = -1;
+        newprocessPtr->readysince = 0;
+        newprocessPtr->waited = 0;
         newprocessPtr->mbytes = 0;
         newprocessPtr->memoryblock = NULL;
         newprocessPtr->req.printers = 0;
@@ -206,7 +372,12 @@ PcbPtr createnullPcb()
         newprocessPtr->req.modems = 0;
         newprocessPtr->req.cds = 0;
         newprocessPtr->status = PCB_UNINITIALIZED;
+        newprocessPtr->stopping = FALSE;
+        newprocessPtr->ticks = 0;
+        newprocessPtr->cpu = -1;
+        newprocessPtr->seq = 0;
         newprocessPtr->next = NULL;
+        newprocessPtr->prev = NULL;
         return newprocessPtr;
     }
     perror("allocating memory for new process");
@@ -214,48 +385,211 @@ PcbPtr createnullPcb()
 }   
 
 /*******************************************************
- * PcbPtr enqPcb (PcbPtr headofQ, PcbPtr process)
- *    - queue process (or join queues) at end of queue
- * 
- * returns head of queue
+ * void freePcb(PcbPtr process) - give Pcb back to PcbPool
+ *  returns:
+ *    void
  ******************************************************/
  
-PcbPtr enqPcb(PcbPtr q, PcbPtr p)
+void freePcb(PcbPtr p)
 {
-    PcbPtr h = q;
-    
-    p->next = NULL; 
-    if (q) {
-        while (q->next) q = q->next;
-        q->next = p;
-        return h;
-    }
+    if (p->pidfd != -1)
+        close(p->pidfd);
+    poolFree(&PcbPool, p);
+}
+
+/*******************************************************
+ * void initPcbQueue (PcbQueuePtr q) - make q empty
+ *******************************************************/
+
+void initPcbQueue(PcbQueuePtr q)
+{
+    q->head = q->tail = NULL;
+    q->length = 0;
+}
+
+/*******************************************************
+ * PcbPtr enqPcbQueue (PcbQueuePtr q, PcbPtr process)
+ *    - enqueue process at tail of q
+ *
+ * returns process
+ *******************************************************/
+
+PcbPtr enqPcbQueue(PcbQueuePtr q, PcbPtr p)
+{
+    p->next = NULL;
+    p->prev = q->tail;
+    if (q->tail)
+        q->tail->next = p;
+    else
+        q->head = p;
+    q->tail = p;
+    q->length++;
     return p;
 }
+
 /*******************************************************
- * PcbPtr deqPcb (PcbPtr * headofQ);
- *    - dequeue process - take Pcb from head of queue.
+ * PcbPtr deqPcbQueue (PcbQueuePtr q)
+ *    - dequeue process from head of q
  *
  * returns:
  *    PcbPtr if dequeued,
  *    NULL if queue was empty
- *    & sets new head of Q pointer in adrs at 1st arg
  *******************************************************/
- 
-PcbPtr deqPcb(PcbPtr * hPtr)
+
+PcbPtr deqPcbQueue(PcbQueuePtr q)
 {
-    PcbPtr p;
-     
-    if (hPtr && (p = * hPtr)) {
-        * hPtr = p->next;
-        return p;
+    return q->head ? rmPcbQueue(q, q->head) : NULL;
+}
+
+/*******************************************************
+ * PcbPtr rmPcbQueue (PcbQueuePtr q, PcbPtr process)
+ *    - take process out of q wherever it is
+ *
+ * returns process
+ *******************************************************/
+
+PcbPtr rmPcbQueue(PcbQueuePtr q, PcbPtr p)
+{
+    if (p->prev)
+        p->prev->next = p->next;
+    else
+        q->head = p->next;
+    if (p->next)
+        p->next->prev = p->prev;
+    else
+        q->tail = p->prev;
+    p->next = p->prev = NULL;
+    q->length--;
+    return p;
+}
+
+/*******************************************************
+ * PcbPtr insPcbQueue (PcbQueuePtr q, PcbPtr process, PcbBefore before)
+ *    - insert process in order
+ *
+ * returns process
+ *******************************************************/
+
+PcbPtr insPcbQueue(PcbQueuePtr q, PcbPtr p, PcbBefore before)
+{
+    PcbPtr after = q->tail;
+
+    while (after && before(p, after))
+        after = after->prev;
+    if (!after) {                       // goes first
+        p->prev = NULL;
+        p->next = q->head;
+        if (q->head)
+            q->head->prev = p;
+        else
+            q->tail = p;
+        q->head = p;
+    } else {
+        p->prev = after;
+        p->next = after->next;
+        if (after->next)
+            after->next->prev = p;
+        else
+            q->tail = p;
+        after->next = p;
     }
-    return NULL;
+    q->length++;
+    return p;
+}
+
+/*******************************************************
+ * void initPcbLevels (PcbLevelsPtr l) - make every level empty
+ *******************************************************/
+
+void initPcbLevels(PcbLevelsPtr l)
+{
+    int n;
+
+    for (n = 0; n < MAX_QUEUES; n++)
+        initPcbQueue(&l->level[n]);
+    l->nonempty = 0;
+    l->length = 0;
+}
+
+/*******************************************************
+ * PcbPtr enqPcbLevel (PcbLevelsPtr l, PcbPtr process, int level)
+ *    - enqueue process at tail of level
+ *
+ * returns process
+ *******************************************************/
+
+PcbPtr enqPcbLevel(PcbLevelsPtr l, PcbPtr p, int level)
+{
+    enqPcbQueue(&l->level[level], p);
+    l->nonempty |= 1u << level;
+    l->length++;
+    return p;
+}
+
+/*******************************************************
+ * PcbPtr deqPcbLevel (PcbLevelsPtr l, int level)
+ *    - dequeue process from head of level
+ *
+ * returns:
+ *    PcbPtr if dequeued,
+ *    NULL if level was empty
+ *******************************************************/
+
+PcbPtr deqPcbLevel(PcbLevelsPtr l, int level)
+{
+    PcbPtr p = l->level[level].head;
+
+    return p ? rmPcbLevel(l, p, level) : NULL;
+}
+
+/*******************************************************
+ * PcbPtr rmPcbLevel (PcbLevelsPtr l, PcbPtr process, int level)
+ *    - take process out of level wherever it is
+ *
+ * returns process
+ *******************************************************/
+
+PcbPtr rmPcbLevel(PcbLevelsPtr l, PcbPtr p, int level)
+{
+    rmPcbQueue(&l->level[level], p);
+    if (!l->level[level].head)
+        l->nonempty &= ~(1u << level);
+    l->length--;
+    return p;
+}
+
+/*******************************************************
+ * int topPcbLevel (PcbLevelsPtr l)
+ *
+ * returns highest priority (lowest numbered) non-empty level
+ *         -1 if every level is empty
+ *******************************************************/
+
+int topPcbLevel(PcbLevelsPtr l)
+{
+    return ffs(l->nonempty) - 1;
+}
+
+/*******************************************************
+ * int countPcbLevels (PcbLevelsPtr l, int n)
+ *
+ * returns number of processes in levels 0 .. n - 1
+ *******************************************************/
+
+int countPcbLevels(PcbLevelsPtr l, int n)
+{
+    unsigned int bits;
+    int count = 0;
+
+    if (n >= MAX_QUEUES) return l->length;
+    for (bits = l->nonempty & ((1u << n) - 1); bits; bits &= bits - 1)
+        count += l->level[ffs(bits) - 1].length;
+    return count;
 }
 
 char* getPcbNickName(PcbPtr p)
 {
-    char* nick_name = malloc(sizeof(char) * 100);
+    char* nick_name = p->nickname;
     
     // Arrival time
     char arrival_time[10];
@@ -8,35 +8,63 @@
 
   PcbPtr startPcb(PcbPtr process) - start (or restart) a process
   PcbPtr suspendPcb(PcbPtr process) - suspend a process
+  PcbPtr stopPcb(PcbPtr process) - suspend a process, don't wait
+  PcbPtr stoppedPcb(PcbPtr process, int wait) - see a stop through
   PcbPtr terminatePcb(PcbPtr process) - terminate a process
   PcbPtr printPcb(PcbPtr process, FILE * iostream)
   void printPcbHdr(FILE *) - print header for printPcb
   PcbPtr createnullPcb(void) - create inactive Pcb.
-  PcbPtr enqPcb (PcbPtr headofQ, PcbPtr process)
-  PcbPtr deqPcb (PcbPtr * headofQ);
+  void freePcb(PcbPtr) - give Pcb back to PcbPool
+  void initPcbQueue (PcbQueuePtr q)
+  PcbPtr enqPcbQueue (PcbQueuePtr q, PcbPtr process)
+  PcbPtr deqPcbQueue (PcbQueuePtr q)
+  PcbPtr rmPcbQueue (PcbQueuePtr q, PcbPtr process)
+  PcbPtr insPcbQueue (PcbQueuePtr q, PcbPtr process, PcbBefore before)
+  void initPcbLevels (PcbLevelsPtr l)
+  PcbPtr enqPcbLevel (PcbLevelsPtr l, PcbPtr process, int level)
+  PcbPtr deqPcbLevel (PcbLevelsPtr l, int level)
+  PcbPtr rmPcbLevel (PcbLevelsPtr l, PcbPtr process, int level)
+  int topPcbLevel (PcbLevelsPtr l)
+  int countPcbLevels (PcbLevelsPtr l, int n)
 
   see pcb.c for fuller description of function arguments and returns
 
  ********************************************************************
 
-  version: 1.2 (exercise 11 and final project)
+  version: 1.15
   date:    December 2003
   author:  Dr Ian G Graham, ian.graham@griffith.edu.au
   history:
      v1.0: Original for exercises 7, 8, & 9
      v1.1: Add reference to memory block structure for exercise 10
      v1.2: Add resource allocation
+     v1.3: Simulated processes (see sim.c)
+     v1.4: Remember last cpu for work stealing
+     v1.5: O(1) PcbQueue and PcbLevels (head/tail, non-empty bitmap)
+     v1.6: Pcbs come from PcbPool, nick name kept in the Pcb
+     v1.7: seq, input order for ties between processes
+     v1.8: Start jobs on parked workers when there are any (worker.c)
+     v1.9: posix_spawn launch, processes signalled through a pidfd
+     v1.10: stopPcb/stoppedPcb, suspend without waiting for the stop
+     v1.11: PcbLevels hold up to MAX_QUEUES levels (set at run time)
+     v1.12: tickets and pass for proportional share scheduling
+     v1.13: red-black tree links (see rbtree.c)
+     v1.14: deadline, insPcbQueue for an ordered (EDF) queue
+     v1.15: admission, dispatch and suspend times for statistics
  *******************************************************************/
 
 #include "mab.h"
 #include "rsrc.h"
+#include "pool.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <signal.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <unistd.h> 
 #include <string.h>
+#include <strings.h>
 
 #ifndef FALSE
 #define FALSE 0
@@ -49,15 +77,20 @@
 /* process management definitions *****************************/
 
 #define MAXARGS 4
+#define NICKNAME_SIZE 100
 
 #define DEFAULT_PROCESS "./process"
 
-#define N_QUEUES         4  /* number of queues (including RT) */
+#define N_QUEUES         4  /* number of queues (including RT) by default */
+#define MAX_QUEUES      32  /* most a PcbLevels holds (bits in nonempty) */
 #define RT_PRIORITY      0
 #define HIGH_PRIORITY    1
-#define LOW_PRIORITY     (N_QUEUES - 1)
+#define LOW_PRIORITY     (N_QUEUES - 1)  /* lowest in a dispatch file */
 #define N_FB_QUEUES      (LOW_PRIORITY - HIGH_PRIORITY + 1)
 
+#define DEFAULT_TICKETS  100  /* a lowest priority job's share, doubling */
+                              /*  at each level above it */
+
 #define PCB_UNINITIALIZED 0
 #define PCB_INITIALIZED 1
 #define PCB_READY 2
@@ -67,32 +100,86 @@
 
 struct pcb {
     pid_t pid;
+    int pidfd;                 // -1 if none (see launch.c)
     char * args[MAXARGS];
     char * ans_file;
+    char nickname[NICKNAME_SIZE];  // see getPcbNickName
     int arrivaltime;
     int priority;
     int remainingcputime;
+    int tickets;               // share of the cpu (stride, lottery, cfs)
+    long long pass;            //  and virtual time used so far (stride
+                               //  pass, cfs virtual runtime)
+    int deadline;              // time it must end by, INT_MAX if none
+    int tier;                  // priority it arrived with (statistics)
+    int admitted;              // time admitted, -1 until it is
+    int started;               //  first dispatched, -1 until it is
+    int readysince;            //  last suspended
+    int waited;                // ticks ready but not running so far
     int mbytes;
     MabPtr memoryblock;
     Rsrc req;
     int status;
+    int stopping;              // sent SIGTSTP, stop not yet seen (stopPcb)
+    int ticks;                 // ticks reported (simulation only)
+    int cpu;                   // cpu it last ran on, -1 if never run
+    long long seq;             // input order (dispatch file, then line)
     struct pcb * next;
+    struct pcb * prev;         // (PcbQueue only)
+    struct pcb * child[2];     // (PcbTree only) left, right
+    struct pcb * parent;       //  (NULL at the root)
+    int red;                   //  red or black
 }; 
 
 typedef struct pcb Pcb;
 typedef Pcb * PcbPtr;
 
+typedef int (* PcbBefore)(PcbPtr, PcbPtr);  // order of a heap or tree,
+                                            //  TRUE if a comes out first
+
+struct pcbqueue {
+    PcbPtr head;
+    PcbPtr tail;
+    int length;
+};
+
+typedef struct pcbqueue PcbQueue;
+typedef PcbQueue * PcbQueuePtr;
+
+struct pcblevels {
+    PcbQueue level[MAX_QUEUES];
+    unsigned int nonempty;     // bit n set if level[n] is not empty
+    int length;                // processes in all levels
+};
+
+typedef struct pcblevels PcbLevels;
+typedef PcbLevels * PcbLevelsPtr;
+
 /* process management prototypes *****************************/
 
 PcbPtr startPcb(PcbPtr);
 PcbPtr suspendPcb(PcbPtr);
+PcbPtr stopPcb(PcbPtr);
+PcbPtr stoppedPcb(PcbPtr, int);
 PcbPtr terminatePcb(PcbPtr);
 PcbPtr printPcb(PcbPtr, FILE *);
 void   printPcbHdr(FILE *);
 PcbPtr createnullPcb();
-PcbPtr enqPcb(PcbPtr, PcbPtr);
-PcbPtr deqPcb(PcbPtr*);
+void   freePcb(PcbPtr);
+void   initPcbQueue(PcbQueuePtr);
+PcbPtr enqPcbQueue(PcbQueuePtr, PcbPtr);
+PcbPtr deqPcbQueue(PcbQueuePtr);
+PcbPtr rmPcbQueue(PcbQueuePtr, PcbPtr);
+PcbPtr insPcbQueue(PcbQueuePtr, PcbPtr, PcbBefore);
+void   initPcbLevels(PcbLevelsPtr);
+PcbPtr enqPcbLevel(PcbLevelsPtr, PcbPtr, int);
+PcbPtr deqPcbLevel(PcbLevelsPtr, int);
+PcbPtr rmPcbLevel(PcbLevelsPtr, PcbPtr, int);
+int    topPcbLevel(PcbLevelsPtr);
+int    countPcbLevels(PcbLevelsPtr, int);
 char* getPcbNickName(PcbPtr p);
 void num_char(int x, char *s);
 
+extern Pool PcbPool;
+
 #endif
@@ -0,0 +1,153 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  pool - fixed size record allocator for HOST dispatcher
+
+   Pcb and Mab records are created and freed for every job and every
+   memory split. Rather than a malloc/free each time, records are
+   carved out of page sized chunks and kept on an intrusive free list
+   (the first word of a free record points to the next free record).
+   Chunks are never returned one by one; poolDestroy releases them
+   all together at exit.
+
+   void * poolAlloc (PoolPtr pool)
+      - take a record from the free list, growing the pool by one
+        chunk if the list is empty
+    returns:
+      pointer to the record (contents undefined)
+      NULL if a new chunk could not be allocated
+
+   void poolFree (PoolPtr pool, void * record)
+      - put record back on the free list
+    returns NONE
+
+   void poolDestroy (PoolPtr pool)
+      - free every chunk; all records become invalid
+    returns NONE
+
+   void poolPrint (PoolPtr pool, FILE * iostream)
+      - print in use / high water / chunk statistics on iostream
+    returns NONE
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: pooled Pcb and Mab records
+
+ *******************************************************************/
+
+#include "pool.h"
+#include <unistd.h>
+
+#define ALIGN sizeof(void *)   // records and chunk header alignment
+
+/*******************************************************
+ * static int poolGrow (PoolPtr pool)
+ *    - add one chunk of records to the free list
+ *
+ * returns:
+ *    1 if ok
+ *    0 if malloc failed
+ *******************************************************/
+static int poolGrow(PoolPtr pool)
+{
+    size_t rsize, page;
+    char * chunk, * r;
+    int n;
+
+    if (!pool->perchunk) {                       // first time: work out layout
+        if (pool->size < sizeof(void *)) pool->size = sizeof(void *);
+        pool->size = (pool->size + ALIGN - 1) / ALIGN * ALIGN;
+        page = (size_t) sysconf(_SC_PAGESIZE);
+        pool->chunksize = page;
+        while (pool->chunksize < ALIGN + pool->size)  // at least one record
+            pool->chunksize += page;
+        pool->perchunk = (pool->chunksize - ALIGN) / pool->size;
+    }
+    rsize = pool->size;
+
+    if (!(chunk = malloc(pool->chunksize)))
+        return 0;
+    * (void **) chunk = pool->chunks;            // link chunk in
+    pool->chunks = chunk;
+    pool->nchunks++;
+
+    r = chunk + ALIGN;                           // thread records onto free list
+    for (n = 0; n < pool->perchunk; n++, r += rsize) {
+        * (void **) r = pool->freelist;
+        pool->freelist = r;
+    }
+    return 1;
+}
+
+/*******************************************************
+ * void * poolAlloc (PoolPtr pool)
+ *    - allocate a record
+ *
+ * returns:
+ *    pointer to the record
+ *    NULL if a new chunk could not be allocated
+ *******************************************************/
+void * poolAlloc(PoolPtr pool)
+{
+    void * r;
+
+    if (!pool->freelist && !poolGrow(pool))
+        return NULL;
+    r = pool->freelist;
+    pool->freelist = * (void **) r;
+    pool->allocs++;
+    if (++pool->inuse > pool->highwater)
+        pool->highwater = pool->inuse;
+    return r;
+}
+
+/*******************************************************
+ * void poolFree (PoolPtr pool, void * record)
+ *    - give a record back
+ *
+ * returns NONE
+ *******************************************************/
+void poolFree(PoolPtr pool, void * r)
+{
+    if (!r) return;
+    * (void **) r = pool->freelist;
+    pool->freelist = r;
+    pool->inuse--;
+}
+
+/*******************************************************
+ * void poolDestroy (PoolPtr pool)
+ *    - release every chunk at once
+ *
+ * returns NONE
+ *******************************************************/
+void poolDestroy(PoolPtr pool)
+{
+    void * chunk;
+
+    while ((chunk = pool->chunks)) {
+        pool->chunks = * (void **) chunk;
+        free(chunk);
+    }
+    pool->freelist = NULL;
+    pool->nchunks = 0;
+    pool->inuse = 0;
+}
+
+/*******************************************************
+ * void poolPrint (PoolPtr pool, FILE * iostream)
+ *    - print pool statistics
+ *
+ * returns NONE
+ *******************************************************/
+void poolPrint(PoolPtr pool, FILE * iostream)
+{
+    fprintf(iostream, "%s pool: %d in use, high water %d, %ld allocs, "
+        "%d chunks of %d (%lu bytes)\n",
+        pool->name, pool->inuse, pool->highwater, pool->allocs,
+        pool->nchunks, pool->perchunk,
+        (unsigned long) (pool->nchunks * pool->chunksize));
+}
@@ -0,0 +1,56 @@
+#ifndef POOL_H
+#define POOL_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  pool - fixed size record allocator for HOST dispatcher
+
+  void * poolAlloc (PoolPtr pool) - allocate a record
+  void poolFree (PoolPtr pool, void * record) - give a record back
+  void poolDestroy (PoolPtr pool) - release every chunk at once
+  void poolPrint (PoolPtr pool, FILE * iostream) - print statistics
+
+  Pool mypool = POOL_INITIALIZER("name", sizeof(record));
+
+  see pool.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: pooled Pcb and Mab records
+
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* pool definitions *******************************************/
+
+struct pool {
+    char * name;               // for poolPrint
+    size_t size;               // record size (rounded up on first use)
+    void * freelist;           // free records, linked through their first word
+    void * chunks;             // chunks, linked through their first word
+    int perchunk;              // records in each chunk
+    size_t chunksize;          // bytes in each chunk (whole pages)
+    int nchunks;               // chunks allocated
+    int inuse;                 // records handed out
+    int highwater;             // most records ever handed out at once
+    long allocs;               // poolAlloc calls
+};
+
+typedef struct pool Pool;
+typedef Pool * PoolPtr;
+
+#define POOL_INITIALIZER(name, size) { name, size, NULL, NULL, 0, 0, 0, 0, 0, 0 }
+
+/* pool prototypes ********************************************/
+
+void * poolAlloc(PoolPtr);
+void   poolFree(PoolPtr, void *);
+void   poolDestroy(PoolPtr);
+void   poolPrint(PoolPtr, FILE *);
+
+#endif
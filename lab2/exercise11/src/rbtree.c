@@ -0,0 +1,253 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  rbtree - red-black tree of processes for HOST dispatcher
+
+   A red-black tree ordered by a 'before' function, linked through the
+   child and parent fields of the pcbs themselves so that inserting
+   and removing never allocate. Insert and remove are O(log n); the
+   leftmost (first) process is cached, so looking at it is O(1), as
+   the completely fair scheduler needs every time it picks the next
+   process. As with the heap, a 'before' function that needs a stable
+   order for equal processes should fall back on the pcb's seq.
+
+   void initPcbTree (PcbTreePtr t, PcbBefore before)
+      - make t empty, ordered by before(a, b) (TRUE if a comes first)
+    returns NONE
+
+   PcbPtr insPcbTree (PcbTreePtr t, PcbPtr process)
+      - add process to t (after any equal to it)
+    returns process
+
+   PcbPtr rmPcbTree (PcbTreePtr t, PcbPtr process)
+      - remove process, which must be on t
+    returns process
+
+   PcbPtr firstPcbTree (PcbTreePtr t)
+    returns:
+      PcbPtr of the first process (left on t)
+      NULL if t is empty
+
+   PcbPtr nextPcbTree (PcbPtr process)
+    returns:
+      PcbPtr of the process after process on its tree
+      NULL if it is the last
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: red-black tree with a cached leftmost process (cfs)
+
+ *******************************************************************/
+
+#include "rbtree.h"
+
+static void rotate(PcbTreePtr, PcbPtr, int);
+static void replace(PcbTreePtr, PcbPtr, PcbPtr);
+
+#define RED(p) ((p) && (p)->red)
+
+/*******************************************************
+ * void initPcbTree (PcbTreePtr t, PcbBefore before) - make t empty
+ *******************************************************/
+
+void initPcbTree(PcbTreePtr t, PcbBefore before)
+{
+    t->root = t->leftmost = NULL;
+    t->length = 0;
+    t->before = before;
+}
+
+/*******************************************************
+ * PcbPtr insPcbTree (PcbTreePtr t, PcbPtr process)
+ *    - add process to t
+ *
+ * returns process
+ *******************************************************/
+
+PcbPtr insPcbTree(PcbTreePtr t, PcbPtr process)
+{
+    PcbPtr p = process, parent = NULL, n = t->root, grand, uncle;
+    int dir = 0, leftmost = TRUE;
+
+    while (n) {                 // down to the leaf it goes in
+        parent = n;
+        if ((dir = !t->before(p, n)))
+            leftmost = FALSE;
+        n = n->child[dir];
+    }
+    p->parent = parent;
+    p->child[0] = p->child[1] = NULL;
+    p->red = TRUE;
+    if (parent)
+        parent->child[dir] = p;
+    else
+        t->root = p;
+    if (leftmost)
+        t->leftmost = p;
+    t->length++;
+
+    // a red child of a red parent: recolour up the tree while the
+    // uncle is red, then at most two rotations
+    while ((parent = p->parent) && parent->red) {
+        grand = parent->parent;    // (the root is black, so there is one)
+        dir = parent == grand->child[1];
+        uncle = grand->child[!dir];
+        if (RED(uncle)) {
+            parent->red = uncle->red = FALSE;
+            grand->red = TRUE;
+            p = grand;
+            continue;
+        }
+        if (p == parent->child[!dir]) {   // inside: make it outside
+            rotate(t, parent, dir);
+            p = parent;
+            parent = p->parent;
+        }
+        parent->red = FALSE;
+        grand->red = TRUE;
+        rotate(t, grand, !dir);
+    }
+    t->root->red = FALSE;
+    return process;
+}
+
+/*******************************************************
+ * PcbPtr rmPcbTree (PcbTreePtr t, PcbPtr process)
+ *    - remove process from t
+ *
+ * returns process
+ *******************************************************/
+
+PcbPtr rmPcbTree(PcbTreePtr t, PcbPtr z)
+{
+    PcbPtr y, x, parent, w;
+    int red = z->red, dir;
+
+    if (t->leftmost == z)
+        t->leftmost = nextPcbTree(z);
+    if (!z->child[0] || !z->child[1]) {
+        x = z->child[!z->child[0] ? 1 : 0];
+        parent = z->parent;
+        replace(t, z, x);
+    } else {                    // z's successor y takes its place
+        for (y = z->child[1]; y->child[0]; y = y->child[0]);
+        red = y->red;
+        x = y->child[1];
+        if (y->parent == z)
+            parent = y;
+        else {
+            parent = y->parent;
+            replace(t, y, x);
+            y->child[1] = z->child[1];
+            y->child[1]->parent = y;
+        }
+        replace(t, z, y);
+        y->child[0] = z->child[0];
+        y->child[0]->parent = y;
+        y->red = z->red;
+    }
+    t->length--;
+    if (red)
+        return z;
+
+    // a black node has gone from under parent: x (which may be NULL)
+    // carries an extra black up until it can be made red or rotated in
+    while (x != t->root && !RED(x)) {
+        dir = x == parent->child[1];
+        w = parent->child[!dir];   // (not NULL, it has a black to spare)
+        if (w->red) {
+            w->red = FALSE;
+            parent->red = TRUE;
+            rotate(t, parent, dir);
+            w = parent->child[!dir];
+        }
+        if (!RED(w->child[0]) && !RED(w->child[1])) {
+            w->red = TRUE;
+            x = parent;
+            parent = x->parent;
+            continue;
+        }
+        if (!RED(w->child[!dir])) {
+            w->child[dir]->red = FALSE;
+            w->red = TRUE;
+            rotate(t, w, !dir);
+            w = parent->child[!dir];
+        }
+        w->red = parent->red;
+        parent->red = FALSE;
+        w->child[!dir]->red = FALSE;
+        rotate(t, parent, dir);
+        x = t->root;
+    }
+    if (x)
+        x->red = FALSE;
+    return z;
+}
+
+/*******************************************************
+ * PcbPtr firstPcbTree (PcbTreePtr t)
+ *
+ * returns:
+ *    PcbPtr of the first process
+ *    NULL if t is empty
+ *******************************************************/
+
+PcbPtr firstPcbTree(PcbTreePtr t)
+{
+    return t->leftmost;
+}
+
+/*******************************************************
+ * PcbPtr nextPcbTree (PcbPtr process)
+ *
+ * returns:
+ *    PcbPtr of the next process on its tree
+ *    NULL if there is none
+ *******************************************************/
+
+PcbPtr nextPcbTree(PcbPtr p)
+{
+    if (p->child[1]) {
+        for (p = p->child[1]; p->child[0]; p = p->child[0]);
+        return p;
+    }
+    while (p->parent && p == p->parent->child[1])
+        p = p->parent;
+    return p->parent;
+}
+
+/*******************************************************
+ * void rotate (PcbTreePtr t, PcbPtr x, int dir)
+ *    - rotate the subtree at x towards dir (0 left, 1 right):
+ *      x's other child takes its place
+ *******************************************************/
+
+static void rotate(PcbTreePtr t, PcbPtr x, int dir)
+{
+    PcbPtr y = x->child[!dir];
+
+    x->child[!dir] = y->child[dir];
+    if (y->child[dir])
+        y->child[dir]->parent = x;
+    replace(t, x, y);
+    y->child[dir] = x;
+    x->parent = y;
+}
+
+/*******************************************************
+ * void replace (PcbTreePtr t, PcbPtr u, PcbPtr v)
+ *    - put v (which may be NULL) where u hangs from its parent
+ *******************************************************/
+
+static void replace(PcbTreePtr t, PcbPtr u, PcbPtr v)
+{
+    if (!u->parent)
+        t->root = v;
+    else
+        u->parent->child[u == u->parent->child[1]] = v;
+    if (v)
+        v->parent = u->parent;
+}
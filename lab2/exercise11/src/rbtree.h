@@ -0,0 +1,47 @@
+#ifndef RBTREE_H
+#define RBTREE_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  rbtree - red-black tree of processes for HOST dispatcher
+
+  void initPcbTree (PcbTreePtr t, PcbBefore before) - make t empty
+  PcbPtr insPcbTree (PcbTreePtr t, PcbPtr process) - add process
+  PcbPtr rmPcbTree (PcbTreePtr t, PcbPtr process) - remove process
+  PcbPtr firstPcbTree (PcbTreePtr t) - the leftmost process, O(1)
+  PcbPtr nextPcbTree (PcbPtr process) - the process after it
+
+  see rbtree.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: red-black tree with a cached leftmost process (cfs)
+
+ *******************************************************************/
+
+#include "pcb.h"
+
+/* tree definitions ********************************************/
+
+struct pcbtree {
+    PcbPtr root;               // linked through the pcbs' child and parent
+    PcbPtr leftmost;           // the first, NULL if empty
+    int length;
+    PcbBefore before;          // ordering
+};
+
+typedef struct pcbtree PcbTree;
+typedef PcbTree * PcbTreePtr;
+
+/* tree prototypes *********************************************/
+
+void   initPcbTree(PcbTreePtr, PcbBefore);
+PcbPtr insPcbTree(PcbTreePtr, PcbPtr);
+PcbPtr rmPcbTree(PcbTreePtr, PcbPtr);
+PcbPtr firstPcbTree(PcbTreePtr);
+PcbPtr nextPcbTree(PcbPtr);
+
+#endif
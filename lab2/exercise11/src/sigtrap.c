@@ -22,12 +22,36 @@
     
   output is to stdout (set in #define), reset to BLACK and NORMAL
   and flushed after every printf.
+
+  started as 'sigtrap -p' by the dispatcher's worker pool, the program
+  first waits (parked) for its job on stdin: nick name, answer file
+  and tick count, each '\0' terminated, ended by end of file. it
+  exits quietly if stdin ends before a job arrives.
+
+  an answer file given as '&n' is the descriptor n, already open for
+  appending (the dispatcher's posix_spawn launch opens it on 3).
+
+  ticks are boundaries on a CLOCK_MONOTONIC grid slept to with
+  clock_nanosleep(TIMER_ABSTIME) (clock.c), so the time spent on one
+  tick does not push the next one back. started by the dispatcher,
+  the grid - epoch and tick length - is the dispatcher's own, taken
+  from the environment (a parked worker gets it with its job), so
+  the first tick ends when the dispatcher's does; after a SIGCONT the
+  ticks stay on the same grid, the tick it was continued in ending
+  with the dispatcher's however late the signal was delivered (or the
+  one after, if the dispatcher has restarted its ticks since and a
+  boundary is less than half a tick away). a stop or termination signal arriving
+  with less than half a tick to go counts the tick as done. with
+  hostd -s, the ticks' lateness is printed on stderr at exit.
       
  ********************************************************************
    version: 1.0
    date:    December 2003
    author:  Dr Ian G Graham, ian.graham@griffith.edu.au
    history: derived from original simple sleep process (Exercise 1)
+            -p parked mode for the dispatcher's worker pool
+            '&n' answer file, inherited descriptor
+            absolute tick deadlines on the dispatcher's clock (clock.c)
 
  *******************************************************************/
 #include <stdio.h>
@@ -36,11 +60,12 @@
 #include <unistd.h>
 #include <signal.h>
 #include <ctype.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/time.h>
-#include <sys/times.h>
 #include <limits.h>
 #include <sys/resource.h>
+#include "clock.h"
 
 #ifndef TRUE
 #define TRUE 1
@@ -54,8 +79,10 @@ static void SignalHandler(int);
 void        PrintUsage(char*);   // for error exit & info 
 char       *StripPath(char*);    // strip path from filename
 void        WriteAnswer(char*, char*, char*);
+int         ReadJob(char*, int, char**, char**, int*);
 
 #define DEFAULT_TIME 20
+#define PARKED       "-p"        // wait for the job on stdin
 
 // Fu Comment
 // #define DEFAULT_OP   stdout
@@ -109,21 +136,34 @@ static int signal_SIGABRT = FALSE;
 static int signal_SIGCONT = FALSE;
 static int signal_SIGTSTP = FALSE;
 
+static ClockStats lateness;           // of the ticks (see clock.c)
+static char * clockname = DEFAULT_NAME;  // name to print them under
+
+static void PrintClock(void)
+{
+    clockPrint(&lateness, clockname, stderr);
+}
+
 /*******************************************************************/
 
 int main(int argc, char *argv[])
 {
     pid_t pid = getpid();             // get process id 
     int i, cycle, rc;    
-    long clktck = sysconf(_SC_CLK_TCK);
-    struct tms t;
-    clock_t starttick, stoptick;
+    long long epoch, tickns, next, now, missed;
+    int stats = FALSE;
     sigset_t mask;
 
     // Fu Add
     FILE * output = stdout;
     char * nick_name = argv[1];
     char * ans_file = argv[2];
+    char job[PIPE_BUF];
+    int ticks = DEFAULT_TIME;
+
+    if (argc > 1 && !strcmp(argv[1], PARKED) &&
+        !ReadJob(job, sizeof(job), &nick_name, &ans_file, &ticks))
+        exit(0);                      // released unused
     
     colour = colours[pid % N_COLOUR]; // select colour for this process
 	
@@ -144,23 +184,42 @@ int main(int argc, char *argv[])
     signal (SIGTSTP, SignalHandler);
                                         	
     rc = setpriority(PRIO_PROCESS, 0, 20); // be nice, lower priority by 20 	
-    cycle = DEFAULT_TIME;  // get tick count 
+    cycle = ticks;  // get tick count 
     if (cycle <= 0) cycle = 1;
 
+    now = clockNow();
+    if (!clockImport(&epoch, &tickns, &stats)) {
+        epoch = now;                   // on our own, 1 second ticks from now
+        tickns = CLOCK_NS;
+    }
+    next = clockNext(epoch, tickns, now);  // first tick ends with the dispatcher's
+    if (stats) {
+        clockname = nick_name;
+        atexit(PrintClock);
+    }
+
     for (i = 0; i < cycle;) {          // tick 
 
         if (signal_SIGCONT) {
             signal_SIGCONT = FALSE;
+            now = clockNow();          // continued at a dispatcher tick,
+            next = clockNext(epoch, tickns, now);  //  which ends on the grid
+            if (next - now < tickns / 2)
+                next += tickns;
             fprintf(output,"%s%7d; SIGCONT" BLACK NORMAL "\n", colour, (int) pid);
             fflush(output);
             WriteAnswer(ans_file, nick_name, "SIGCONT");
         }
             
-        starttick = times (&t);        // use timer to ascertain whether 'tick' should be
-        rc = sleep(1);                 //  reported
-        stoptick = times (&t);
+        rc = clockSleepUntil(next);    // sleep to the tick boundary, a signal
+        now = clockNow();              //  ending it with most of it gone counts
          
-        if (rc == 0 || (stoptick-starttick) > clktck/2) {
+        if (rc == 0 || now >= next ||
+            ((signal_SIGINT || signal_SIGQUIT || signal_SIGHUP || signal_SIGTSTP ||
+              signal_SIGABRT || signal_SIGTERM) && next - now < tickns / 2)) {
+            missed = now > next ? (now - next) / tickns : 0;
+            clockLate(&lateness, next, now, missed);
+            next += (missed + 1) * tickns;   // stay on the grid
             fprintf(output,"%s%7d; tick %d" BLACK NORMAL "\n", colour, (int) pid, ++i);
             WriteAnswer(ans_file, nick_name, "tick");
         }
@@ -312,13 +371,60 @@ char * StripPath(char * pathname)
 
 /*******************************************************************
 
+int ReadJob(char * job, int size, char ** nick_name, char ** ans_file,
+            int * ticks);
+
+read a parked worker's job from stdin into job (size bytes)
+
+returns TRUE if a job was read, with nick_name, ans_file (pointing
+into job) and ticks set (and the dispatcher's clock, if it came with
+the job, put in the environment)
+        FALSE at end of file before a complete job
+*******************************************************************/
+
+int ReadJob(char * job, int size, char ** nick_name, char ** ans_file,
+            int * ticks)
+{
+    int n = 0, rc;
+    char * end;
+
+    while (n < size && (rc = read(STDIN_FILENO, job + n, size - n)) != 0) {
+        if (rc > 0) n += rc;
+        else if (errno != EINTR) return FALSE;
+    }
+    end = job + n;
+    *nick_name = job;
+    if (!(*ans_file = memchr(job, '\0', n)) || ++*ans_file >= end)
+        return FALSE;
+    if (!(job = memchr(*ans_file, '\0', end - *ans_file)) || ++job >= end ||
+        !memchr(job, '\0', end - job))
+        return FALSE;
+    if ((*ticks = atoi(job)) <= 0) *ticks = DEFAULT_TIME;
+    job += strlen(job) + 1;           // the dispatcher's clock, if given
+    if (job < end && *job && memchr(job, '\0', end - job))
+        setenv(CLOCK_ENV, job, TRUE);
+    return TRUE;
+}
+
+/*******************************************************************
+
 void WriteAnswer(char * nick_name, char * content);
 
-Write the scheduling answer into auxiliary file.
+Write the scheduling answer into auxiliary file ('&n' - descriptor n).
 *******************************************************************/
 
 void WriteAnswer(char * ans_file, char * nick_name, char * content)
 {
+    char line[PIPE_BUF];
+    int n;
+
+    if (ans_file[0] == '&' && isdigit((int) ans_file[1])) {
+        n = snprintf(line, sizeof(line), "%s %s\n", nick_name, content);
+        if (n > (int) sizeof(line) - 1) n = sizeof(line) - 1;
+        if (write(atoi(ans_file + 1), line, n) != n)  // one append
+            perror("WriteAnswer");
+        return;
+    }
     FILE * ans_aux_file = fopen(ans_file, "a+");
     fprintf(ans_aux_file, "%s %s\n", nick_name, content);
     fflush(ans_aux_file);
@@ -0,0 +1,108 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  sim - virtual time process simulation for HOST dispatcher
+
+   In simulation mode no 'process' is ever forked. The pcb functions
+   write the lines that sigtrap's WriteAnswer would have written
+   (START, tick, SIGTSTP, SIGCONT, SIGINT) straight into the answer
+   file, and the dispatcher advances its timer without waiting, so a
+   dispatch file is replayed as fast as the policies can run.
+
+   int simOpen(char * ans_file)
+      - truncate and open the answer file with a large buffer
+    returns:
+      TRUE if ok
+      FALSE if the file could not be opened
+
+   void simAnswer(PcbPtr p, char * content)
+      - write "<nick name> <content>" for process p
+    returns NONE
+
+   int simTick(PcbPtr p)
+      - write a tick for running process p; like the real process
+        it ends on its own after SIM_PROCESS_TICKS ticks
+    returns:
+      TRUE if the process is still alive
+      FALSE if it has now ended (status set to PCB_TERMINATED)
+
+   void simClose(void)
+      - flush and close the answer file
+    returns NONE
+
+   extern int SimMode; - TRUE when processes are simulated
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: --simulate mode, no fork and no sleep
+
+ *******************************************************************/
+
+#include "sim.h"
+
+int SimMode = FALSE;
+
+static FILE * ans_stream = NULL;
+
+/*******************************************************
+ * int simOpen(char * ans_file)
+ *    - open the answer stream
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if the file could not be opened
+ *******************************************************/
+int simOpen(char * ans_file)
+{
+    if (!(ans_stream = fopen(ans_file, "w"))) {
+        perror(ans_file);
+        return FALSE;
+    }
+    setvbuf(ans_stream, NULL, _IOFBF, SIM_BUFFER_SIZE);
+    return TRUE;
+}
+
+/*******************************************************
+ * void simAnswer(PcbPtr p, char * content)
+ *    - record one event of process p
+ *
+ * returns NONE
+ *******************************************************/
+void simAnswer(PcbPtr p, char * content)
+{
+    if (ans_stream)
+        fprintf(ans_stream, "%s %s\n", p->args[1], content);
+}
+
+/*******************************************************
+ * int simTick(PcbPtr p)
+ *    - record one tick of running process p
+ *
+ * returns:
+ *    TRUE if the process is still alive
+ *    FALSE if it has now ended on its own
+ *******************************************************/
+int simTick(PcbPtr p)
+{
+    simAnswer(p, "tick");
+    if (++p->ticks >= SIM_PROCESS_TICKS) {
+        p->status = PCB_TERMINATED;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*******************************************************
+ * void simClose(void)
+ *    - flush and close the answer stream
+ *
+ * returns NONE
+ *******************************************************/
+void simClose(void)
+{
+    if (ans_stream) fclose(ans_stream);
+    ans_stream = NULL;
+}
@@ -0,0 +1,42 @@
+#ifndef SIM_H
+#define SIM_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  sim - virtual time process simulation for HOST dispatcher
+
+  int simOpen(char * ans_file) - open the answer stream
+  void simAnswer(PcbPtr p, char * content) - record one event
+  int simTick(PcbPtr p) - record one tick of a running process
+  void simClose(void) - flush and close the answer stream
+
+  extern int SimMode; - TRUE when processes are simulated
+
+  see sim.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: --simulate mode, no fork and no sleep
+
+ *******************************************************************/
+
+#include "pcb.h"
+
+/* simulation definitions *************************************/
+
+#define SIM_PROCESS_TICKS 20    /* lifetime of 'process' (sigtrap DEFAULT_TIME) */
+#define SIM_BUFFER_SIZE   (1 << 20)
+
+extern int SimMode;
+
+/* simulation prototypes *************************************/
+
+int  simOpen(char *);
+void simAnswer(PcbPtr, char *);
+int  simTick(PcbPtr);
+void simClose(void);
+
+#endif
@@ -0,0 +1,486 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  submit - job submission socket for HOST dispatcher
+
+   Jobs can be handed to a running dispatcher as well as read from
+   dispatch files: it listens on a unix domain stream socket, and a
+   client (hostctl) connects, writes a batch of jobs, shuts down its
+   side of the connection and reads back an acknowledgement. A batch
+   is either text, lines of a dispatch file, or binary, JOB_MAGIC, a
+   uint32 count of fields per record and that many int32 fields per
+   record. Either way each job arrives at the tick it is read in: its
+   first field is replaced by the dispatcher's timer (a deadline is
+   still counted from there).
+
+   The listening socket and every connection are non-blocking and
+   watched by the event loop (evWatch), so a slow client never holds
+   up a tick; a batch is only parsed once the client's end of file
+   has been read, so a batch is never queued in part. The reply is
+   kept with the connection and sent as the client takes it (the
+   connection watched for output instead), the connection being
+   dropped with an error if it is not all taken in SUBMIT_TIMEOUT
+   ticks. The reply is a
+   "queued <id> <job>" line for each job queued, where id is the job's
+   seq (unique among the jobs of this dispatcher) and job its name in
+   the answer file, then "done <queued> <rejected>". A batch that is
+   just "shutdown" closes the socket instead, so the dispatcher ends
+   once the jobs it has are done.
+
+   int submitOpen (SubmitterPtr s, char * path, char * ans_file,
+                   int source)
+      - bind and listen on a unix socket at path, replacing a stale
+        one (a socket nothing listens on) but never anything else,
+        jobs submitted will be given ans_file as answer file and
+        source (see loadOpen) orders them after those of the dispatch
+        files arriving at the same time
+    returns:
+      TRUE if ok
+      FALSE if the socket could not be set up (errno set, EEXIST
+        if path is not a socket, EADDRINUSE if a dispatcher is still
+        listening on it)
+
+   int submitJobs (SubmitterPtr s, PcbHeapPtr h, int timer)
+      - accept new connections, read what is waiting on each, push on
+        h the jobs of every batch now complete, arriving at timer (bad
+        lines or records are reported and skipped), and send what
+        replies the clients will take; called whenever evWait reports
+        EV_INPUT or EV_OUTPUT and every tick while there are clients
+        (see submitActive)
+    returns:
+      number of jobs pushed on h
+
+   int submitActive (SubmitterPtr s)
+    returns:
+      TRUE if still listening or a batch is still being read or
+        replied to
+      FALSE otherwise
+
+   void submitClose (SubmitterPtr s)
+      - close the socket (and any connection) and remove it
+    returns NONE
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: text and binary batches, acknowledged with job ids
+
+ *******************************************************************/
+
+#define _GNU_SOURCE               /* accept4 */
+#include "submit.h"
+#include "event.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*******************************************************
+ * static void Reply (ClientPtr c, char * text, size_t size, int timer)
+ *    - make malloc'ed text (NULL if it could not be made) the reply
+ *      to a client, freeing the batch it sent, and watch it for
+ *      output
+ *
+ * returns NONE
+ *******************************************************/
+static void Reply(ClientPtr c, char * text, size_t size, int timer)
+{
+    free(c->buffer);
+    c->buffer = NULL;
+    c->size = c->room = 0;
+    c->ack = text;
+    c->acksize = size;
+    c->acksent = 0;
+    c->since = timer;
+    if (text)
+        evWatch(c->fd, TRUE);      // else it is tried every tick
+}
+
+/*******************************************************
+ * static int Send (ClientPtr c)
+ *    - send as much of a client's reply as it will take
+ *
+ * returns:
+ *    1 if it has all been sent
+ *    0 if there is more to send
+ *    -1 if the client has gone
+ *******************************************************/
+static int Send(ClientPtr c)
+{
+    ssize_t n;
+
+    while (c->acksent < c->acksize) {
+        if ((n = send(c->fd, c->ack + c->acksent, c->acksize - c->acksent,
+                      MSG_NOSIGNAL | MSG_DONTWAIT)) > 0)
+            c->acksent += n;
+        else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return 0;
+        else if (n == 0 || errno != EINTR)
+            return -1;
+    }
+    return 1;
+}
+
+/*******************************************************
+ * static int Queue (SubmitterPtr s, PcbHeapPtr h, int * f,
+ *                   FILE * ack)
+ *    - queue the job of fields f and acknowledge it
+ *
+ * returns:
+ *    TRUE if it was queued
+ *    FALSE if not
+ *******************************************************/
+static int Queue(SubmitterPtr s, PcbHeapPtr h, int * f, FILE * ack)
+{
+    PcbPtr process;
+
+    if (!(process = loadPcb(f, s->ans_file, s->seq)))
+        return FALSE;
+    if (!pushPcbHeap(h, process)) {
+        freePcb(process);
+        return FALSE;
+    }
+    fprintf(ack, "queued %lld %s\n", s->seq++ & ((1LL << LOAD_SEQ_BITS) - 1),
+        getPcbNickName(process));
+    return TRUE;
+}
+
+/*******************************************************
+ * static int Binary (SubmitterPtr s, ClientPtr c, PcbHeapPtr h,
+ *                    int timer, FILE * ack, int * rejected)
+ *    - queue the records of a binary batch
+ *
+ * returns number of jobs queued
+ *******************************************************/
+static int Binary(SubmitterPtr s, ClientPtr c, PcbHeapPtr h, int timer,
+                  FILE * ack, int * rejected)
+{
+    int f[LOAD_FIELDS];
+    const char * at = c->buffer + sizeof(JOB_MAGIC) - 1;
+    size_t left = c->size - (sizeof(JOB_MAGIC) - 1);
+    uint32_t fields, i;
+    int32_t v;
+    int n = 0;
+
+    if (left < sizeof(fields)) {
+        fprintf(stderr, "ERROR - submission: no field count\n");
+        (*rejected)++;
+        return 0;
+    }
+    memcpy(&fields, at, sizeof(fields));
+    at += sizeof(fields);
+    left -= sizeof(fields);
+    if (fields < JOB_MIN_FIELDS || fields > JOB_FIELDS) {
+        fprintf(stderr, "ERROR - submission: %u fields per record, "
+            "expected %d to %d\n", fields, JOB_MIN_FIELDS, JOB_FIELDS);
+        (*rejected)++;
+        return 0;
+    }
+    for (; left >= fields * sizeof(v); left -= fields * sizeof(v)) {
+        for (i = 0; i < LOAD_FIELDS; i++) {
+            v = 0;                     // no tickets or deadline given
+            if (i < fields)
+                memcpy(&v, at + i * sizeof(v), sizeof(v));
+            f[i] = v;
+        }
+        at += fields * sizeof(v);
+        f[0] = timer;
+        if (Queue(s, h, f, ack)) n++;
+        else (*rejected)++;
+    }
+    if (left) {
+        fprintf(stderr, "ERROR - submission: %zu bytes of a record left over\n",
+            left);
+        (*rejected)++;
+    }
+    return n;
+}
+
+/*******************************************************
+ * static int Text (SubmitterPtr s, ClientPtr c, PcbHeapPtr h,
+ *                  int timer, FILE * ack, int * rejected)
+ *    - queue the lines of a text batch (the parser takes and
+ *      frees the client's buffer)
+ *
+ * returns number of jobs queued
+ *******************************************************/
+static int Text(SubmitterPtr s, ClientPtr c, PcbHeapPtr h, int timer,
+                FILE * ack, int * rejected)
+{
+    int f[LOAD_FIELDS];
+    Parser parser;
+    int n = 0, k;
+
+    parseBuffer(&parser, "submission", c->buffer, c->size);
+    c->buffer = NULL;
+    while ((k = parseLine(&parser, f, LOAD_MIN_FIELDS, LOAD_FIELDS))) {
+        while (k < LOAD_FIELDS)
+            f[k++] = 0;                // no tickets or deadline given
+        f[0] = timer;
+        if (Queue(s, h, f, ack)) n++;
+        else (*rejected)++;
+    }
+    *rejected += parser.errors;
+    parseClose(&parser);
+    return n;
+}
+
+/*******************************************************
+ * static int Batch (SubmitterPtr s, ClientPtr c, PcbHeapPtr h,
+ *                   int timer)
+ *    - act on a complete batch and make the reply to it (no
+ *      reply if it could not be made)
+ *
+ * returns number of jobs queued
+ *******************************************************/
+static int Batch(SubmitterPtr s, ClientPtr c, PcbHeapPtr h, int timer)
+{
+    size_t magic = sizeof(JOB_MAGIC) - 1, len = c->size;
+    char * text = NULL;
+    size_t size = 0;
+    int n = 0, rejected = 0;
+    FILE * ack;
+
+    while (len && (c->buffer[len - 1] == '\n' || c->buffer[len - 1] == ' '))
+        len--;
+    if (len == strlen(SUBMIT_SHUTDOWN) &&
+        !memcmp(c->buffer, SUBMIT_SHUTDOWN, len)) {
+        if (s->fd != -1) {
+            evUnwatch(s->fd);
+            close(s->fd);
+            unlink(s->path);
+            s->fd = -1;
+        }
+        Reply(c, strdup("shutting down\n"), strlen("shutting down\n"), timer);
+        return 0;
+    }
+    if (!(ack = open_memstream(&text, &size)))
+        return 0;
+    if (c->size >= magic && !memcmp(c->buffer, JOB_MAGIC, magic))
+        n = Binary(s, c, h, timer, ack, &rejected);
+    else
+        n = Text(s, c, h, timer, ack, &rejected);
+    fprintf(ack, "done %d %d\n", n, rejected);
+    fclose(ack);
+    Reply(c, text, size, timer);
+    s->jobs += n;
+    s->rejected += rejected;
+    return n;
+}
+
+/*******************************************************
+ * static int Receive (ClientPtr c)
+ *    - read what a client has sent
+ *
+ * returns:
+ *    1 if its batch is complete
+ *    0 if there is more to come
+ *    -1 if it failed or sent too much
+ *******************************************************/
+static int Receive(ClientPtr c)
+{
+    ssize_t n;
+    char * more;
+
+    for (;;) {
+        if (c->size == c->room) {
+            if (c->room >= SUBMIT_MAX ||
+                !(more = realloc(c->buffer, c->room ? 2 * c->room : 4096)))
+                return -1;
+            c->buffer = more;
+            c->room = c->room ? 2 * c->room : 4096;
+        }
+        if ((n = read(c->fd, c->buffer + c->size, c->room - c->size)) > 0)
+            c->size += n;
+        else if (n == 0)
+            return 1;
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        else if (errno != EINTR)
+            return -1;
+    }
+}
+
+/*******************************************************
+ * static void Drop (SubmitterPtr s, int i)
+ *    - close client i
+ *
+ * returns NONE
+ *******************************************************/
+static void Drop(SubmitterPtr s, int i)
+{
+    ClientPtr c = &s->clients[i];
+
+    evUnwatch(c->fd);
+    close(c->fd);
+    free(c->buffer);
+    free(c->ack);
+    *c = s->clients[--s->nclients];
+}
+
+/*******************************************************
+ * static int Clear (struct sockaddr_un * addr)
+ *    - make way for a socket: there must be nothing at its
+ *      path or a stale socket, left by a dispatcher that died,
+ *      which is removed
+ *
+ * returns:
+ *    TRUE if the path is clear
+ *    FALSE if not (errno set)
+ *******************************************************/
+static int Clear(struct sockaddr_un * addr)
+{
+    struct stat st;
+    int fd, rc;
+
+    if (lstat(addr->sun_path, &st) == -1)
+        return errno == ENOENT;
+    if (!S_ISSOCK(st.st_mode)) {
+        errno = EEXIST;
+        return FALSE;
+    }
+    if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) == -1)
+        return FALSE;
+    rc = connect(fd, (struct sockaddr *) addr, sizeof(*addr));
+    close(fd);
+    if (rc == 0) {                     // someone is listening
+        errno = EADDRINUSE;
+        return FALSE;
+    }
+    if (errno != ECONNREFUSED)
+        return FALSE;
+    return unlink(addr->sun_path) == 0;
+}
+
+/*******************************************************
+ * int submitOpen (SubmitterPtr s, char * path, char * ans_file,
+ *                 int source)
+ *    - listen for submissions
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if the socket could not be set up
+ *******************************************************/
+int submitOpen(SubmitterPtr s, char * path, char * ans_file, int source)
+{
+    struct sockaddr_un addr;
+
+    memset(s, 0, sizeof(Submitter));
+    s->path = path;
+    s->ans_file = ans_file;
+    s->seq = (long long) source << LOAD_SEQ_BITS;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        s->fd = -1;
+        return FALSE;
+    }
+    strcpy(addr.sun_path, path);
+    if (!Clear(&addr)) {
+        s->fd = -1;
+        return FALSE;
+    }
+    if ((s->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        0)) == -1)
+        return FALSE;
+    if (bind(s->fd, (struct sockaddr *) &addr, sizeof(addr)) == -1 ||
+        listen(s->fd, SUBMIT_CLIENTS) == -1 || !evWatch(s->fd, FALSE)) {
+        close(s->fd);
+        s->fd = -1;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*******************************************************
+ * int submitJobs (SubmitterPtr s, PcbHeapPtr h, int timer)
+ *    - take in submissions
+ *
+ * returns:
+ *    number of jobs pushed on h
+ *******************************************************/
+int submitJobs(SubmitterPtr s, PcbHeapPtr h, int timer)
+{
+    ClientPtr c;
+    int fd, i, n = 0, done;
+
+    while (s->fd != -1 &&
+           (fd = accept4(s->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+        if (s->nclients == SUBMIT_CLIENTS || !evWatch(fd, FALSE)) {
+            // a fresh socket has room for this much, never waited for
+            send(fd, "error busy\n", strlen("error busy\n"),
+                MSG_NOSIGNAL | MSG_DONTWAIT);
+            close(fd);
+            continue;
+        }
+        c = &s->clients[s->nclients++];
+        memset(c, 0, sizeof(Client));
+        c->fd = fd;
+    }
+    for (i = 0; i < s->nclients; ) {
+        c = &s->clients[i];
+        if (!c->ack) {
+            if (!(done = Receive(c))) {
+                i++;
+                continue;
+            }
+            if (done == 1)
+                n += Batch(s, c, h, timer);
+            else {
+                fprintf(stderr, "ERROR - submission: %s\n",
+                    c->room >= SUBMIT_MAX ? "batch too large" : strerror(errno));
+                Reply(c, strdup("error\n"), strlen("error\n"), timer);
+            }
+            if (!c->ack) {             // no reply could be made
+                Drop(s, i);            // moves the last client to i
+                continue;
+            }
+        }
+        if (!(done = Send(c)) && timer - c->since < SUBMIT_TIMEOUT) {
+            i++;
+            continue;
+        }
+        if (!done)
+            fprintf(stderr, "ERROR - submission: reply not taken in %d ticks, "
+                "%zu of %zu bytes sent\n", SUBMIT_TIMEOUT, c->acksent, c->acksize);
+        Drop(s, i);
+    }
+    return n;
+}
+
+/*******************************************************
+ * int submitActive (SubmitterPtr s)
+ *
+ * returns:
+ *    TRUE if still listening or reading a batch
+ *******************************************************/
+int submitActive(SubmitterPtr s)
+{
+    return s->fd != -1 || s->nclients > 0;
+}
+
+/*******************************************************
+ * void submitClose (SubmitterPtr s)
+ *    - stop taking submissions
+ *
+ * returns NONE
+ *******************************************************/
+void submitClose(SubmitterPtr s)
+{
+    while (s->nclients)
+        Drop(s, s->nclients - 1);
+    if (s->fd != -1) {
+        evUnwatch(s->fd);
+        close(s->fd);
+        unlink(s->path);
+        s->fd = -1;
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef SUBMIT_H
+#define SUBMIT_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  submit - job submission socket for HOST dispatcher
+
+  int submitOpen (SubmitterPtr s, char * path, char * ans_file,
+                  int source) - listen for jobs on a unix socket
+  int submitJobs (SubmitterPtr s, PcbHeapPtr h, int timer)
+      - take in submissions, pushing their jobs on h
+  int submitActive (SubmitterPtr s) - check if still taking jobs
+  void submitClose (SubmitterPtr s) - stop listening and remove socket
+
+  see submit.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: text and binary batches, acknowledged with job ids
+
+ *******************************************************************/
+
+#include "pcb.h"
+#include "heap.h"
+#include "loader.h"
+
+/* submission definitions **************************************/
+
+#define SUBMIT_PATH     "hostd.sock"   /* default socket (hostctl) */
+#define SUBMIT_CLIENTS  16             /* submissions read at once */
+#define SUBMIT_MAX      (64 << 20)     /* bytes in a submission, at most */
+#define SUBMIT_TIMEOUT  5              /* ticks an acknowledgement may take */
+#define SUBMIT_SHUTDOWN "shutdown"     /* submission that closes the socket */
+
+/* a binary submission is JOB_MAGIC, a uint32 count of fields per record
+   (JOB_MIN_FIELDS to JOB_FIELDS) and the records, int32 fields in the
+   order of a dispatch file line, in the sender's byte order */
+
+struct client {
+    int fd;
+    char * buffer;             // what it has sent so far
+    size_t size;               //  its length
+    size_t room;               //  and the room for it
+    char * ack;                // reply to it once it has all been read
+    size_t acksize;            //  its length
+    size_t acksent;            //  and how much the client has taken
+    int since;                 // timer when the reply was ready
+};
+
+typedef struct client Client;
+typedef Client * ClientPtr;
+
+struct submitter {
+    char * path;               // socket path
+    int fd;                    // listening socket, -1 once closed
+    char * ans_file;           // given to every pcb created
+    long long seq;             // seq of the next job
+    Client clients[SUBMIT_CLIENTS];
+    int nclients;              // connections still sending
+    long long jobs;            // jobs queued
+    long long rejected;        // records rejected
+};
+
+typedef struct submitter Submitter;
+typedef Submitter * SubmitterPtr;
+
+/* submission prototypes ***************************************/
+
+int  submitOpen(SubmitterPtr, char *, char *, int);
+int  submitJobs(SubmitterPtr, PcbHeapPtr, int);
+int  submitActive(SubmitterPtr);
+void submitClose(SubmitterPtr);
+
+#endif
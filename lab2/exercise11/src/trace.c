@@ -0,0 +1,217 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  trace - Chrome/Perfetto trace of the dispatch timeline
+
+   Writes trace event JSON (the format chrome://tracing and
+   ui.perfetto.dev load): an object whose "traceEvents" array holds
+   one event per line. Tracks are (pid, tid) pairs, named by
+   metadata events. A job's run on a cpu is a B/E (begin/end)
+   duration event on that cpu's track, a signal it is sent an
+   instant event there, and queue lengths, memory and i/o resources
+   are counter events, one track for each key of their arguments.
+
+   Events go through a TRACE_BUFFER_SIZE stdio buffer, so the
+   dispatcher only makes a system call for a megabyte of them, and
+   a counter whose values are the same as last time is not written
+   at all. Timestamps are microseconds, given by the caller.
+
+   int traceOpen (char * file)
+      - truncate and open file for a trace with a large buffer
+    returns:
+      TRUE if ok (TraceMode set)
+      FALSE if the file could not be opened
+
+   void traceName (int pid, int tid, char * name)
+      - name track (pid, tid), or the group of tracks pid if tid is -1
+    returns NONE
+
+   void traceBegin (long long us, int pid, int tid, char * name,
+                    char * cat)
+      - start a duration event name (in category cat) on a track
+    returns NONE
+
+   void traceEnd (long long us, int pid, int tid)
+      - end the last duration event begun on a track
+    returns NONE
+
+   void traceInstant (long long us, int pid, int tid, char * name,
+                      char * job)
+      - an instant event name on a track, for job
+    returns NONE
+
+   void traceCounter (long long us, int pid, char * name, int n,
+                      char ** keys, long long * values)
+      - the n values of counter name, one track for each key, if
+        they have changed since it was last written (name is kept,
+        so it should be a string constant)
+    returns NONE
+
+   void traceClose (void)
+      - finish the JSON, flush and close the trace
+    returns NONE
+
+   extern int TraceMode; - TRUE while a trace is being written
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: trace event JSON, buffered
+
+ *******************************************************************/
+
+#include "trace.h"
+#include <string.h>
+
+int TraceMode = FALSE;
+
+static FILE * trace_stream = NULL;
+static char * counter_name[TRACE_COUNTERS];     // counters written
+static char counter_args[TRACE_COUNTERS][TRACE_ARGS];  //  and their last values
+static int ncounters = 0;
+static long long nevents = 0;                 // events written
+
+/*******************************************************
+ * static FILE * Event (void)
+ *    - start the next event (after a comma unless it is
+ *      the first)
+ *
+ * returns the trace stream
+ *******************************************************/
+static FILE * Event(void)
+{
+    fputs(nevents++ ? ",\n" : "\n", trace_stream);
+    return trace_stream;
+}
+
+/*******************************************************
+ * int traceOpen (char * file)
+ *    - open the trace
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if the file could not be opened
+ *******************************************************/
+int traceOpen(char * file)
+{
+    if (!(trace_stream = fopen(file, "w"))) {
+        perror(file);
+        return FALSE;
+    }
+    setvbuf(trace_stream, NULL, _IOFBF, TRACE_BUFFER_SIZE);
+    fprintf(trace_stream, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    nevents = 0;
+    TraceMode = TRUE;
+    return TRUE;
+}
+
+/*******************************************************
+ * void traceName (int pid, int tid, char * name)
+ *    - name a track
+ *
+ * returns NONE
+ *******************************************************/
+void traceName(int pid, int tid, char * name)
+{
+    if (!trace_stream)
+        return;
+    if (tid == -1)
+        fprintf(Event(), "{\"name\":\"process_name\",\"ph\":\"M\","
+            "\"pid\":%d,\"args\":{\"name\":\"%s\"}}", pid, name);
+    else
+        fprintf(Event(), "{\"name\":\"thread_name\",\"ph\":\"M\","
+            "\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", pid, tid, name);
+}
+
+/*******************************************************
+ * void traceBegin (long long us, int pid, int tid, char * name,
+ *                  char * cat)
+ *    - begin a duration event
+ *
+ * returns NONE
+ *******************************************************/
+void traceBegin(long long us, int pid, int tid, char * name, char * cat)
+{
+    if (trace_stream)
+        fprintf(Event(), "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"B\","
+            "\"ts\":%lld,\"pid\":%d,\"tid\":%d}", name, cat, us, pid, tid);
+}
+
+/*******************************************************
+ * void traceEnd (long long us, int pid, int tid)
+ *    - end a duration event
+ *
+ * returns NONE
+ *******************************************************/
+void traceEnd(long long us, int pid, int tid)
+{
+    if (trace_stream)
+        fprintf(Event(), "{\"ph\":\"E\",\"ts\":%lld,\"pid\":%d,"
+            "\"tid\":%d}", us, pid, tid);
+}
+
+/*******************************************************
+ * void traceInstant (long long us, int pid, int tid, char * name,
+ *                    char * job)
+ *    - an instant event
+ *
+ * returns NONE
+ *******************************************************/
+void traceInstant(long long us, int pid, int tid, char * name, char * job)
+{
+    if (trace_stream)
+        fprintf(Event(), "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+            "\"ts\":%lld,\"pid\":%d,\"tid\":%d,\"args\":{\"job\":\"%s\"}}",
+            name, us, pid, tid, job);
+}
+
+/*******************************************************
+ * void traceCounter (long long us, int pid, char * name, int n,
+ *                    char ** keys, long long * values)
+ *    - a counter event, if its values have changed
+ *
+ * returns NONE
+ *******************************************************/
+void traceCounter(long long us, int pid, char * name, int n, char ** keys,
+                  long long * values)
+{
+    char args[TRACE_ARGS];
+    int i, len = 0, k;
+
+    if (!trace_stream)
+        return;
+    for (i = 0; i < n && len < TRACE_ARGS; i++)
+        len += snprintf(args + len, TRACE_ARGS - len, "%s\"%s\":%lld",
+            i ? "," : "", keys[i], values[i]);
+    for (k = 0; k < ncounters; k++)   // same as last time?
+        if (counter_name[k] == name || !strcmp(counter_name[k], name)) {
+            if (!strcmp(counter_args[k], args))
+                return;
+            break;
+        }
+    if (k < TRACE_COUNTERS) {
+        if (k == ncounters)
+            counter_name[ncounters++] = name;
+        strcpy(counter_args[k], args);
+    }
+    fprintf(Event(), "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%lld,"
+        "\"pid\":%d,\"args\":{%s}}", name, us, pid, args);
+}
+
+/*******************************************************
+ * void traceClose (void)
+ *    - finish the trace
+ *
+ * returns NONE
+ *******************************************************/
+void traceClose(void)
+{
+    if (!trace_stream)
+        return;
+    fprintf(trace_stream, "\n]}\n");
+    fclose(trace_stream);
+    trace_stream = NULL;
+    TraceMode = FALSE;
+}
@@ -0,0 +1,64 @@
+#ifndef TRACE_H
+#define TRACE_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  trace - Chrome/Perfetto trace of the dispatch timeline
+
+  int traceOpen (char * file) - start a trace
+  void traceName (int pid, int tid, char * name) - name a track
+  void traceBegin (long long us, int pid, int tid, char * name,
+      char * cat) - a run interval starts on a track
+  void traceEnd (long long us, int pid, int tid) - and ends
+  void traceInstant (long long us, int pid, int tid, char * name,
+      char * job) - something happens to a job
+  void traceCounter (long long us, int pid, char * name, int n,
+      char ** keys, long long * values) - values of a counter track
+  void traceClose (void) - finish the trace
+
+  extern int TraceMode; - TRUE while a trace is being written
+
+  see trace.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.0
+  history:
+     v1.0: trace event JSON, buffered
+
+ *******************************************************************/
+
+#include <stdio.h>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+/* trace definitions *******************************************/
+
+#define TRACE_BUFFER_SIZE (1 << 20)
+#define TRACE_COUNTERS    8     /* counters whose last values are kept */
+#define TRACE_ARGS        512   /*  room for them */
+
+#define TRACE_CPUS        1     /* pid of the cpu tracks (tid = cpu) */
+#define TRACE_QUEUES      2     /*  of the queue length counters */
+#define TRACE_RESOURCES   3     /*  of the memory and i/o counters */
+
+extern int TraceMode;
+
+/* trace prototypes ********************************************/
+
+int  traceOpen(char *);
+void traceName(int, int, char *);
+void traceBegin(long long, int, int, char *, char *);
+void traceEnd(long long, int, int);
+void traceInstant(long long, int, int, char *, char *);
+void traceCounter(long long, int, char *, int, char **, long long *);
+void traceClose(void);
+
+#endif
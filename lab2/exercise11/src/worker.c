@@ -0,0 +1,247 @@
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  worker - pool of pre-forked 'process' workers for HOST dispatcher
+
+   Starting a job used to mean fork() and execvp() of 'process' at the
+   moment it was dispatched, so every job paid for a fork, an exec and
+   the dynamic loader before it could write START. Here workers are
+   forked and exec'd ahead of time with the WORK_PARKED argument and
+   wait (parked) on a read of their stdin, which is a pipe from the
+   dispatcher. Dispatching a job is then one write of its identity
+   (nick name, answer file, tick budget and the dispatcher's tick grid
+   from CLOCK_ENV, see clock.c, each '\0' terminated) and
+   a close, after which the worker carries on exactly as a freshly
+   started 'process' would. The worker's pid becomes the job's pid.
+
+   Used workers are replaced by workRefill, which the dispatcher calls
+   once it has dispatched everything it can for the tick, so the fork
+   and exec happen while it would otherwise be waiting. If the pool is
+   empty the caller falls back to fork and exec. A worker that dies
+   while parked (most likely it could not exec 'process') turns the
+   pool off.
+
+   int workOpen (char * program, int size)
+      - start size (<= MAX_WORKERS) parked workers running program
+    returns:
+      TRUE if ok
+      FALSE if no worker could be started
+
+   pid_t workStart (char * nickname, char * ans_file, int ticks)
+      - hand a job to a parked worker
+    returns:
+      pid of the worker now running the job
+      0 if no worker is parked
+
+   void workRefill (void)
+      - start workers until size are parked again
+    returns NONE
+
+   int workReaped (pid_t pid)
+      - tell the pool that child pid has been reaped
+    returns:
+      TRUE if it was a parked worker (now forgotten)
+      FALSE if it was not
+
+   void workClose (void)
+      - close the parked workers' pipes (they exit on end of file)
+        and wait for them
+    returns NONE
+
+   void workPrint (FILE * iostream)
+      - print pool statistics
+    returns NONE
+
+ ********************************************************************
+
+  version: 1.1
+  history:
+     v1.0: parked workers fed their job through a pipe
+     v1.1: the job carries the dispatcher's tick grid
+
+ *******************************************************************/
+
+#define _GNU_SOURCE               /* pipe2 */
+#include "worker.h"
+#include "clock.h"
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+static char * program = NULL;     // 'process'
+static int size = 0;              // workers to keep parked
+static pid_t pids[MAX_WORKERS];   // parked workers
+static int fds[MAX_WORKERS];      //  and the write end of their pipes
+static int parked = 0;            // number of them
+static int spawned = 0;           // workers started
+static int handed = 0;            // jobs handed to a parked worker
+static int empty = 0;             // jobs that found the pool empty
+static double handus = 0;         // microseconds spent handing jobs over
+
+/*******************************************************
+ * static int workSpawn (void)
+ *    - fork and exec a parked worker
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if the pipe or fork failed
+ *******************************************************/
+static int workSpawn(void)
+{
+    char * args[] = { program, WORK_PARKED, NULL };
+    sigset_t mask;
+    pid_t pid;
+    int fd[2];
+
+    if (pipe2(fd, O_CLOEXEC) == -1) {
+        perror("workSpawn pipe");
+        return FALSE;
+    }
+    switch (pid = fork()) {
+        case -1:
+            perror("workSpawn fork");
+            close(fd[0]);
+            close(fd[1]);
+            return FALSE;
+        case 0:                                 // child
+            sigemptyset(&mask);                 // don't pass on the
+            sigaddset(&mask, SIGCHLD);          //  dispatcher's blocked
+            sigprocmask(SIG_UNBLOCK, &mask, NULL);  //  SIGCHLD
+            dup2(fd[0], STDIN_FILENO);          // (dup2 clears close on exec)
+            execvp(args[0], args);
+            perror(args[0]);
+            _exit(2);
+    }
+    close(fd[0]);                               // parent
+    pids[parked] = pid;
+    fds[parked++] = fd[1];
+    spawned++;
+    return TRUE;
+}
+
+/*******************************************************
+ * int workOpen (char * program, int size)
+ *    - start the pool
+ *
+ * returns:
+ *    TRUE if ok
+ *    FALSE if no worker could be started
+ *******************************************************/
+int workOpen(char * prog, int n)
+{
+    program = prog;
+    size = n < MAX_WORKERS ? n : MAX_WORKERS;
+    signal(SIGPIPE, SIG_IGN);          // a dead worker is an EPIPE, not a kill
+    workRefill();
+    return parked > 0;
+}
+
+/*******************************************************
+ * pid_t workStart (char * nickname, char * ans_file, int ticks)
+ *    - hand a job to a parked worker
+ *
+ * returns:
+ *    pid of the worker
+ *    0 if none is parked
+ *******************************************************/
+pid_t workStart(char * nickname, char * ans_file, int ticks)
+{
+    char job[PIPE_BUF];               // written in one go
+    char * grid = getenv(CLOCK_ENV);  // as a fresh process would inherit it
+    struct timespec t0, t1;
+    int n;
+
+    n = snprintf(job, sizeof(job), "%s%c%s%c%d%c%s", nickname, '\0', ans_file, '\0',
+        ticks, '\0', grid ? grid : "") + 1;
+    if (n > (int) sizeof(job))
+        return 0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while (parked) {
+        parked--;
+        if (write(fds[parked], job, n) == n) {
+            close(fds[parked]);       // end of file tells it the job is complete
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            handus += (t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3;
+            handed++;
+            return pids[parked];
+        }
+        close(fds[parked]);           // died while parked, it will be reaped
+    }
+    empty++;
+    return 0;
+}
+
+/*******************************************************
+ * void workRefill (void)
+ *    - bring the pool back to size
+ *
+ * returns NONE
+ *******************************************************/
+void workRefill(void)
+{
+    while (parked < size && workSpawn());
+}
+
+/*******************************************************
+ * int workReaped (pid_t pid)
+ *    - forget a parked worker that has been reaped
+ *
+ * returns:
+ *    TRUE if pid was a parked worker
+ *    FALSE otherwise
+ *******************************************************/
+int workReaped(pid_t pid)
+{
+    int i;
+
+    for (i = 0; i < parked; i++) {
+        if (pids[i] == pid) {
+            close(fds[i]);
+            parked--;
+            pids[i] = pids[parked];
+            fds[i] = fds[parked];
+            if (size) {
+                fprintf(stderr, "ERROR - parked worker %d died, worker pool off\n", (int) pid);
+                size = 0;
+            }
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*******************************************************
+ * void workClose (void)
+ *    - release the parked workers
+ *
+ * returns NONE
+ *******************************************************/
+void workClose(void)
+{
+    int i, status;
+
+    for (i = 0; i < parked; i++)
+        close(fds[i]);
+    for (i = 0; i < parked; i++)
+        waitpid(pids[i], &status, 0);
+    parked = size = 0;
+}
+
+/*******************************************************
+ * void workPrint (FILE * iostream)
+ *    - print pool statistics
+ *
+ * returns NONE
+ *******************************************************/
+void workPrint(FILE * stream)
+{
+    fprintf(stream, "workers: %d started, %d jobs handed over (mean %.1f us), "
+        "%d found the pool empty\n", spawned, handed,
+        handed ? handus / handed : 0.0, empty);
+}
@@ -0,0 +1,54 @@
+#ifndef WORKER_H
+#define WORKER_H
+/*******************************************************************
+
+  OS Exercises - Project 2 - HOST dispatcher
+
+  worker - pool of pre-forked 'process' workers for HOST dispatcher
+
+  int workOpen (char * program, int size) - start size parked workers
+  pid_t workStart (char * nickname, char * ans_file, int ticks)
+      - hand a job to a parked worker
+  void workRefill (void) - start workers to bring the pool back to size
+  int workReaped (pid_t pid) - forget a parked worker that has died
+  void workClose (void) - release the parked workers
+  void workPrint (FILE * iostream) - print statistics
+
+  see worker.c for fuller description of function arguments and returns
+
+ ********************************************************************
+
+  version: 1.1
+  history:
+     v1.0: parked workers fed their job through a pipe
+     v1.1: the job carries the dispatcher's tick grid
+
+ *******************************************************************/
+
+#include <stdio.h>
+#include <sys/types.h>
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+/* worker pool definitions *************************************/
+
+#define MAX_WORKERS  256
+#define WORK_PARKED  "-p"       /* 'process' argument: wait for a job on stdin */
+#define WORK_TICKS   20         /* lifetime of a job ('process' DEFAULT_TIME) */
+
+/* worker pool prototypes **************************************/
+
+int   workOpen(char *, int);
+pid_t workStart(char *, char *, int);
+void  workRefill(void);
+int   workReaped(pid_t);
+void  workClose(void);
+void  workPrint(FILE *);
+
+#endif